@@ -0,0 +1,157 @@
+/*! \file arq_bench.cpp
+	\brief Loss test of the reliable packets of SerialTransfer.
+	\details The test connects two SerialTransfer objects through in-memory streams that corrupt some packets, sends
+	reliable packets (SerialTransfer::sendReliable()) with a counter and checks that the receiver gets them once and in order,
+	that the packets dropped by the sender after the retries are skipped by the receiver and that the link never gets stuck.
+
+	Two cases are run: the first packet corrupted with no retries (the following packets must still be delivered),
+	then random losses in both directions. The delivered, lost (dropped by the sender) and pending packets are reported.
+
+	Usage:
+
+	```
+	arq_bench [-n packets] [-l loss %] [-r retries] [-s seed]
+	```
+*/
+
+#include "SerialTransfer.h"
+#include "LoopStream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static constexpr uint32_t TIMEOUT = 2; //!< Retransmission timeout (ms).
+static constexpr uint32_t DEADLINE = 5000; //!< Maximum duration of a case (ms).
+
+/*! \brief An in-memory lossy stream.
+	\details Some writes of the payload of a packet are corrupted (a bit flipped), so the receiver drops the packet for the CRC.
+*/
+class LossyStream : public LoopStream<> {
+public:
+	unsigned loss = 0; //!< Corrupted payloads (%).
+	boolean corruptNext = false; //!< Corrupt the next payload.
+
+	size_t write(const uint8_t* buffer, size_t size) override { //!< Write bytes, maybe corrupted.
+		if ((size > PREAMBLE_SIZE) && (corruptNext || ((unsigned) (rand() % 100) < loss))) {
+			uint8_t bad[MAX_PACKET_SIZE];
+			memcpy(bad, buffer, size);
+			bad[rand() % size] ^= (uint8_t) (1 << (rand() % 8));
+			corruptNext = false;
+			return LoopStream<>::write(bad, size);
+		}
+		return LoopStream<>::write(buffer, size);
+	}
+};
+
+/*! \brief An end of the link.
+	\details Bytes are read from a stream and written to another.
+*/
+class LinkEnd : public Stream {
+public:
+	LinkEnd(Stream* in, Stream* out) : _in(in), _out(out) { } //!< Constructor.
+	int available() override { return _in->available(); } //!< Bytes available for reading.
+	int read() override { return _in->read(); } //!< Read a byte, -1 if none.
+	int peek() override { return _in->peek(); } //!< Next byte without reading it, -1 if none.
+	size_t write(uint8_t b) override { return _out->write(&b, 1); } //!< Write a byte.
+	size_t write(const uint8_t* buffer, size_t size) override { return _out->write(buffer, size); } //!< Write bytes.
+	int availableForWrite(void) override { return _out->availableForWrite(); } //!< Bytes that can be written.
+
+private:
+	Stream* _in; //!< Input.
+	Stream* _out; //!< Output.
+};
+
+//results of a case
+struct Result {
+	uint32_t delivered = 0; //delivered packets
+	uint32_t lost = 0; //packets dropped by the sender
+	uint32_t pending = 0; //packets not acknowledged yet
+	uint32_t last = 0; //last delivered counter
+	boolean ordered = true; //delivered once and in order
+};
+
+//send n reliable packets with a counter, the first one corrupted if requested, and receive them
+static Result run(uint32_t n, unsigned loss, uint8_t retries, boolean corruptFirst) {
+	static LossyStream toRx, toTx;
+	toRx = LossyStream();
+	toTx = LossyStream();
+	LinkEnd txEnd(&toTx, &toRx);
+	LinkEnd rxEnd(&toRx, &toTx);
+	static arqSlotST txSlots[ARQ_WINDOW], rxSlots[ARQ_WINDOW];
+	static uint8_t sendBuff[MAX_PACKET_SIZE], txBlock[RX_BLOCK_SIZE], rxBlock[RX_BLOCK_SIZE];
+	SerialTransfer tx, rx;
+	tx.begin(txEnd, false);
+	rx.begin(rxEnd, false);
+	tx.setReliableBuffers(txSlots, nullptr);
+	rx.setReliableBuffers(nullptr, rxSlots);
+	tx.setSendBuffer(sendBuff);
+	tx.setRxBlock(txBlock, sizeof(txBlock));
+	rx.setRxBlock(rxBlock, sizeof(rxBlock));
+	tx.setReliableTimeout(TIMEOUT, retries);
+	toRx.loss = toTx.loss = loss;
+	toRx.corruptNext = corruptFirst;
+
+	Result res;
+	boolean first = true;
+	uint32_t sent = 0;
+	uint32_t t0 = millis();
+	while ((millis() - t0) < DEADLINE) {
+		if (sent == (n - 1)) toRx.loss = toTx.loss = 0; //last packet not lost, to check that the link is not stuck
+		if (sent < n) {
+			tx.txObj(sent);
+			if (tx.sendReliable(sizeof(sent), 1)) sent++;
+		}
+		tx.tick();
+		if (rx.tick()) {
+			uint32_t val = 0;
+			rx.rxObj(val);
+			if ((rx.currentPacketID() != 1) || (!first && (val <= res.last))) res.ordered = false;
+			first = false;
+			res.last = val;
+			res.delivered++;
+		}
+		if ((sent == n) && (tx.reliablePending() == 0) && !first && (res.last == (n - 1))) break;
+	}
+	res.lost = tx.reliableLost();
+	res.pending = tx.reliablePending();
+	return res;
+}
+
+//report a case
+static boolean report(const char* name, const Result& res, uint32_t n, boolean exact) {
+	boolean ok = res.ordered && (res.pending == 0) && (res.delivered > 0) && (res.last == (n - 1)) && (res.delivered <= n) && ((res.delivered + res.lost) >= n);
+	if (exact) ok = ok && (res.lost == 1) && (res.delivered == (n - 1));
+	printf("%-12s %u packets: delivered=%u lost=%u pending=%u, %s\n", name, n, res.delivered, res.lost, res.pending,
+		!res.ordered ? "OUT OF ORDER" : (res.last != (n - 1)) ? "STUCK" : ok ? "ok" : "FAILED");
+	return ok;
+}
+
+int main(int argc, char** argv) {
+	uint32_t n = 2000; //packets
+	unsigned loss = 10; //corrupted packets (%)
+	uint8_t retries = 3; //retransmissions before dropping
+	unsigned seed = 1; //random seed
+
+	int opt;
+	while ((opt = getopt(argc, argv, "n:l:r:s:h")) != -1) {
+		switch (opt) {
+		case 'n': n = strtoul(optarg, nullptr, 10); break;
+		case 'l': loss = strtoul(optarg, nullptr, 10); break;
+		case 'r': retries = strtoul(optarg, nullptr, 10); break;
+		case 's': seed = strtoul(optarg, nullptr, 10); break;
+		default:
+			printf("Usage: %s [-n packets] [-l loss %%] [-r retries] [-s seed]\n", argv[0]);
+			return (opt == 'h') ? 0 : 1;
+		}
+	}
+	if ((n < 2) || (loss > 50)) {
+		fprintf(stderr, "packets must be at least 2 and loss at most 50%%\n");
+		return 1;
+	}
+	srand(seed);
+
+	boolean ok = report("first lost", run(8, 0, 0, true), 8, true);
+	ok = report("random loss", run(n, loss, retries, false), n, false) && ok;
+	return ok ? 0 : 1;
+}
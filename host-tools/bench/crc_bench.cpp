@@ -0,0 +1,121 @@
+/*! \file crc_bench.cpp
+	\brief Microbenchmark of PacketCRC.
+	\details The benchmark computes the CRCs of SerialTransfer over a buffer and reports the bytes per cycle (x86 time-stamp counter)
+	and the MB/s of the former byte-wise CRC-8 loop and of the slice-by-N CRC-8, CRC-16 and CRC-32 kernels.
+	The results of the former and the new CRC-8 are also compared, and the CRCs are continued over split buffers, to check the tables.
+	The benchmark is built twice, `crc_bench` with the slice-by-8 kernels and `crc_bench4` with the slice-by-4 kernels
+	(`-DPACKETCRC_SLICES=4`, default of Teensy 4).
+
+	Usage:
+
+	```
+	crc_bench [-n bytes] [-r repetitions]
+	```
+
+	where `-n` sets the buffer size (254 by default, i.e. a full SerialTransfer packet).
+*/
+
+#include "PacketCRC.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+PacketCRC crc; //!< As in Packet.cpp.
+
+//former PacketCRC: table generated at runtime, one lookup per byte
+static uint8_t formerTable[256];
+
+static void formerGenerate() {
+	for (uint16_t i = 0; i < 256; ++i) {
+		int curr = i;
+		for (int j = 0; j < 8; ++j) {
+			if ((curr & 0x80) != 0) curr = (curr << 1) ^ (int) CRC8_POLY;
+			else curr <<= 1;
+		}
+		formerTable[i] = (uint8_t) curr;
+	}
+}
+
+static uint8_t formerCalculate(const uint8_t arr[], uint8_t len) {
+	uint8_t c = 0;
+	for (uint16_t i = 0; i < len; i++) c = formerTable[c ^ arr[i]];
+	return c;
+}
+
+//time-stamp counter, or ns if not available
+static uint64_t cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+//monotonic time (ns)
+static uint64_t now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//run a kernel and print its speed
+template <typename F>
+static uint32_t run(const char* name, F f, const std::vector<uint8_t>& buf, size_t reps) {
+	volatile uint32_t sink = 0; //keep the results
+	uint64_t t0 = now(), c0 = cycles();
+	for (size_t r = 0; r < reps; r++) sink = sink + f(buf.data(), buf.size());
+	uint64_t c1 = cycles(), t1 = now();
+	double bytes = (double) buf.size() * reps;
+	printf("%-22s %6.3f bytes/cycle, %8.1f MB/s\n", name, bytes / (c1 - c0), bytes / ((t1 - t0) * 1e-3));
+	return f(buf.data(), buf.size());
+}
+
+int main(int argc, char** argv) {
+	size_t n = 254; //bytes per CRC
+	size_t reps = 200000; //repetitions
+
+	int opt;
+	while ((opt = getopt(argc, argv, "n:r:h")) != -1) {
+		switch (opt) {
+		case 'n': n = strtoul(optarg, nullptr, 10); break;
+		case 'r': reps = strtoul(optarg, nullptr, 10); break;
+		default:
+			printf("Usage: %s [-n bytes] [-r repetitions]\n", argv[0]);
+			return (opt == 'h') ? 0 : 1;
+		}
+	}
+	if ((n == 0) || (n > 0xFFFF)) {
+		fprintf(stderr, "bytes must be between 1 and 65535\n");
+		return 1;
+	}
+
+	std::vector<uint8_t> buf(n);
+	for (size_t i = 0; i < n; i++) buf[i] = (uint8_t) (rand() & 0xFF);
+	formerGenerate();
+
+	printf("buffer:      %zu bytes, %zu repetitions, slice-by-%u (%zu bytes of tables)\n", n, reps, CRC_SLICES, sizeof(PacketCRCTables));
+	uint32_t former = 0;
+	if (n <= 0xFF) { //the former loop takes an uint8_t length
+		former = run("CRC-8 byte-wise", [](const uint8_t* a, size_t l) { return (uint32_t) formerCalculate(a, (uint8_t) l); }, buf, reps);
+	}
+	uint32_t c8 = run("CRC-8 slice-by-N", [](const uint8_t* a, size_t l) { return (uint32_t) PacketCRC::crc8(a, l); }, buf, reps);
+	uint32_t c16 = run("CRC-16 slice-by-N", [](const uint8_t* a, size_t l) { return (uint32_t) PacketCRC::crc16(a, l); }, buf, reps);
+	uint32_t c32 = run("CRC-32 slice-by-N", [](const uint8_t* a, size_t l) { return PacketCRC::crc32(a, l); }, buf, reps);
+
+	const uint8_t check[] = "123456789";
+	size_t half = n / 2 + 1; //odd split, so both parts have a byte-wise tail
+	boolean ok = (PacketCRC::crc16(check, 9) == 0x29B1) && (PacketCRC::crc32(check, 9) == 0xCBF43926) && ((n > 0xFF) || (former == c8));
+	ok = ok && (half >= n || ((PacketCRC::crc8(buf.data() + half, n - half, PacketCRC::crc8(buf.data(), half)) == c8) &&
+		(PacketCRC::crc16(buf.data() + half, n - half, PacketCRC::crc16(buf.data(), half)) == c16) &&
+		(PacketCRC::crc32(buf.data() + half, n - half, PacketCRC::crc32(buf.data(), half)) == c32)));
+	printf("check:       %s\n", ok ? "ok" : "FAILED");
+	return ok ? 0 : 1;
+}
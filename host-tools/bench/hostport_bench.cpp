@@ -0,0 +1,203 @@
+/*! \file hostport_bench.cpp
+	\brief Loopback benchmark of HostPort.
+	\details The benchmark connects a device-side and a host-side HostPort, either through in-memory streams (default)
+	or through a pty, and measures the throughput (frames/s, bytes/s) and the round-trip latency percentiles.
+	No board is required, thus it is used to regression-test the link throughput.
+
+	Usage:
+
+	```
+	hostport_bench [-n frames] [-p payload bytes] [-c 0|16|32] [-t] [-r]
+	```
+
+	where `-c` sets the CRC, `-t` uses a pty instead of the in-memory streams and `-r` makes the host read from an
+	in-memory ring (HostPort::setRing()) instead of the in-memory stream.
+
+	Before the benchmark, a loopback check exchanges packets between HostPortT and HostPort in both directions,
+	with different transmit and receive objects and a self-overlapping header preceded by a partial header.
+*/
+
+#include "HostPort.h"
+#include "HostPortT.h"
+#include "FdStream.h"
+#include "LoopRing.h"
+#include "LoopStream.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+static constexpr uint32_t HEADER = 0xFFFFFFFF; //!< Packet header.
+static constexpr uint32_t TERMINATOR = 0xAAAAAAAA; //!< Packet terminator.
+static constexpr uint32_t CHECK_HEADER = 0xCCBBAAAA; //!< Self-overlapping header of the loopback check (0xAA 0xAA 0xBB 0xCC).
+
+//monotonic time (ns)
+static uint64_t now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//percentile of sorted samples
+static double percentile(const std::vector<uint64_t>& v, double p) {
+	if (v.empty()) return 0;
+	size_t k = (size_t) (p / 100.0 * (v.size() - 1) + 0.5);
+	return (double) v[k];
+}
+
+//loopback check of HostPortT with HostPort, both directions
+static boolean checkHostPortT() {
+	typedef HostPortT<CHECK_HEADER, TERMINATOR, HostPortObjs<uint32_t, float>, HostPortObjs<uint16_t>> DevicePort; //device: tx counter and value, rx command
+	static_assert(DevicePort::TX_DATA_SIZE == 8, "wrong tx size");
+	static_assert(DevicePort::RX_DATA_SIZE == 2, "wrong rx size");
+	static_assert(DevicePort::txOffset<1>() == 4, "wrong tx offset");
+	static LoopStream<> toHost, toDevice;
+	DevicePort dev(&toHost);
+	DevicePort devRx(&toDevice);
+	HostPort hostRx(&toHost, CHECK_HEADER, TERMINATOR);
+	HostPort hostTx(&toDevice, CHECK_HEADER, TERMINATOR);
+	uint32_t counter = 0;
+	float value = 0;
+	uint16_t command = 0;
+	hostRx.attachRx((uint8_t*) &counter, sizeof(counter));
+	hostRx.attachRx((uint8_t*) &value, sizeof(value));
+	hostTx.attachTx((uint8_t*) &command, sizeof(command));
+	const uint8_t partial[] = { 0xAA, 0xAA, 0xAA }; //partial header before each packet
+	size_t ok = 0;
+	for (uint32_t i = 0; i < 100; i++) {
+		toHost.write(partial, sizeof(partial));
+		dev.write(i, 0.5f * i);
+		counter = UINT32_MAX;
+		if (hostRx.read() && (counter == i) && (value == 0.5f * i)) ok++;
+		toDevice.write(partial, sizeof(partial));
+		command = (uint16_t) (1000 + i);
+		hostTx.write();
+		uint16_t cmd = 0;
+		if (devRx.read(cmd) && (cmd == command)) ok++;
+	}
+	printf("hostportt:   %zu/200 packets, %s\n", ok, (ok == 200) ? "ok" : "FAILED");
+	return ok == 200;
+}
+
+int main(int argc, char** argv) {
+	size_t frames = 100000; //num of frames
+	size_t payload = 200; //payload bytes
+	uint8_t crc = HostPort::NO_CRC;
+	boolean pty = false;
+	boolean ring = false;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "n:p:c:trh")) != -1) {
+		switch (opt) {
+		case 'n': frames = strtoul(optarg, nullptr, 10); break;
+		case 'p': payload = strtoul(optarg, nullptr, 10); break;
+		case 'c': crc = (atoi(optarg) == 32) ? HostPort::CRC32 : ((atoi(optarg) == 16) ? HostPort::CRC16 : HostPort::NO_CRC); break;
+		case 't': pty = true; break;
+		case 'r': ring = true; break;
+		default:
+			printf("Usage: %s [-n frames] [-p payload bytes] [-c 0|16|32] [-t] [-r]\n", argv[0]);
+			return (opt == 'h') ? 0 : 1;
+		}
+	}
+	if ((payload < 4) || (payload > (HostPort::BUF_SIZE - 8 - crc))) {
+		fprintf(stderr, "payload must be between 4 and %zu bytes\n", HostPort::BUF_SIZE - 8 - crc);
+		return 1;
+	}
+
+	if (!checkHostPortT()) {
+		return 1;
+	}
+
+	//streams: device-to-host and host-to-device
+	static LoopStream<> toHost, toDevice; //in-memory
+	static LoopRing<> toHostRing; //in-memory ring
+	Stream* devSerial = nullptr; //device side
+	Stream* hostSerial = nullptr; //host side
+	int master, slave;
+	FdStream* fdDev = nullptr;
+	FdStream* fdHost = nullptr;
+	if (pty) {
+		if (!FdStream::openPty(&master, &slave)) {
+			fprintf(stderr, "cannot open pty\n");
+			return 1;
+		}
+		fdDev = new FdStream(slave);
+		fdHost = new FdStream(master);
+		devSerial = fdDev;
+		hostSerial = fdHost;
+	}
+
+	//ports, same framing on both sides
+	std::vector<uint8_t> devTx(payload), devRx(payload), hostTx(payload), hostRx(payload);
+	Stream* toHostStream = ring ? (Stream*) &toHostRing : (Stream*) &toHost;
+	HostPort devTxPort(pty ? devSerial : toHostStream, HEADER, TERMINATOR);
+	HostPort devRxPort(pty ? devSerial : (Stream*) &toDevice, HEADER, TERMINATOR);
+	HostPort hostTxPort(pty ? hostSerial : (Stream*) &toDevice, HEADER, TERMINATOR);
+	HostPort hostRxPort(pty ? hostSerial : toHostStream, HEADER, TERMINATOR);
+	if (ring && !pty) hostRxPort.setRing(&toHostRing); //parse from the ring
+	devTxPort.attachTx(devTx.data(), payload);
+	devRxPort.attachRx(devRx.data(), payload);
+	hostTxPort.attachTx(hostTx.data(), payload);
+	hostRxPort.attachRx(hostRx.data(), payload);
+	devTxPort.setCrc(crc);
+	devRxPort.setCrc(crc);
+	hostTxPort.setCrc(crc);
+	hostRxPort.setCrc(crc);
+	size_t frameSize = 8 + payload + crc;
+
+	//throughput: device streams frames, host reads them
+	size_t received = 0;
+	uint64_t t0 = now();
+	for (size_t i = 0; i < frames; i++) {
+		memcpy(devTx.data(), &i, 4);
+		devTxPort.write();
+		while (hostRxPort.read()) received++;
+	}
+	while (received < frames) { //remaining frames
+		if (!hostRxPort.read()) {
+			if (!pty) break; //nothing more in memory
+			if ((now() - t0) > 10000000000ULL) break; //timeout
+			continue;
+		}
+		received++;
+	}
+	double dt = (now() - t0) * 1e-9;
+	printf("stream:      %s, payload %zu bytes, frame %zu bytes, CRC %u bits\n", pty ? "pty" : (ring ? "memory ring" : "memory"), payload, frameSize, crc * 8);
+	printf("throughput:  %zu/%zu frames in %.3f s, %.0f frames/s, %.2f MB/s\n", received, frames, dt, received / dt, received * frameSize / dt / 1e6);
+
+	//round-trip: host sends, device echoes, host receives
+	size_t rounds = (frames < 10000) ? frames : 10000;
+	std::vector<uint64_t> rtt;
+	rtt.reserve(rounds);
+	for (size_t i = 0; i < rounds; i++) {
+		memcpy(hostTx.data(), &i, 4);
+		uint64_t ts = now();
+		hostTxPort.write();
+		boolean ok = false;
+		while ((now() - ts) < 1000000000ULL) { //1 s timeout
+			if (devRxPort.read()) { //echo
+				memcpy(devTx.data(), devRx.data(), payload);
+				devTxPort.write();
+			}
+			if (hostRxPort.read() && !memcmp(hostRx.data(), &i, 4)) {
+				ok = true;
+				break;
+			}
+		}
+		if (ok) rtt.push_back(now() - ts);
+	}
+	std::sort(rtt.begin(), rtt.end());
+	printf("round-trip:  %zu/%zu frames, p50 %.2f us, p90 %.2f us, p99 %.2f us, max %.2f us\n", rtt.size(), rounds,
+		percentile(rtt, 50) * 1e-3, percentile(rtt, 90) * 1e-3, percentile(rtt, 99) * 1e-3, rtt.empty() ? 0.0 : rtt.back() * 1e-3);
+
+	delete fdDev;
+	delete fdHost;
+	if (pty) {
+		close(master);
+		close(slave);
+	}
+	return (received == frames) && (rtt.size() == rounds) ? 0 : 1;
+}
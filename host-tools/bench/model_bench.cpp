@@ -0,0 +1,183 @@
+/*! \file model_bench.cpp
+	\brief Benchmark of the control model.
+	\details The benchmark calls ControlClass::update() of the generated model (compiled for the host PC) millions of times, with
+	recorded inputs, and reports the ns/step. The outputs of one pass over the inputs are written to a file and compared with a reference,
+	thus a regenerated model is checked for both execution-time and result regressions before running it on the board.
+	The root inports and outports of the model are assumed single precision (real32_T), as in the Simulink model of the project.
+
+	The inputs and the outputs are CSV files with one step per line and one column per inport or outport, in the order of the ExtU and ExtY structs.
+	Lines not starting with a number (e.g. a header) are skipped. Without an input file, sinusoidal inputs are used.
+
+	Usage:
+
+	```
+	model_bench [-i inputs.csv] [-o outputs.csv] [-c reference.csv] [-e tolerance] [-n steps] [-k repetitions] [-b max ns/step]
+	```
+
+	where `-c` compares the outputs with a reference (e.g. saved with `-o` from the previous model) and `-b` fails when the ns/step exceed a budget.
+*/
+
+#include "Arduino.h"
+#include "controlModel.h"
+
+#include <algorithm>
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+typedef ControlClass::ExtU_controlModel_T Inputs; //!< Model inputs.
+typedef ControlClass::ExtY_controlModel_T Outputs; //!< Model outputs.
+
+static constexpr size_t NUM_INPUTS = sizeof(Inputs) / sizeof(real32_T); //!< Number of inports.
+static constexpr size_t NUM_OUTPUTS = sizeof(Outputs) / sizeof(real32_T); //!< Number of outports.
+static_assert(sizeof(Inputs) % sizeof(real32_T) == 0, "inports must be real32_T");
+static_assert(sizeof(Outputs) % sizeof(real32_T) == 0, "outports must be real32_T");
+
+//monotonic time (ns)
+static uint64_t now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//read a CSV file with cols values per line, skipping the lines not starting with a number
+static boolean readCsv(const char* name, size_t cols, std::vector<real32_T>& values) {
+	FILE* file = fopen(name, "r");
+	if (file == nullptr) return false;
+	char line[4096];
+	boolean ok = true;
+	while (ok && fgets(line, sizeof(line), file)) {
+		const char* p = line;
+		while (isspace((unsigned char) *p)) p++;
+		if (!isdigit((unsigned char) *p) && (*p != '-') && (*p != '+') && (*p != '.')) continue; //header or empty
+		for (size_t c = 0; c < cols; c++) {
+			char* end;
+			float val = strtof(p, &end);
+			if (end == p) { //missing column
+				ok = false;
+				break;
+			}
+			values.push_back(val);
+			p = end;
+			while (isspace((unsigned char) *p) || (*p == ',') || (*p == ';')) p++;
+		}
+	}
+	fclose(file);
+	return ok && !values.empty();
+}
+
+//write a CSV file with cols values per line
+static boolean writeCsv(const char* name, size_t cols, const std::vector<real32_T>& values) {
+	FILE* file = fopen(name, "w");
+	if (file == nullptr) return false;
+	for (size_t i = 0; i < values.size(); i++) fprintf(file, "%.9g%c", values[i], ((i + 1) % cols) ? ',' : '\n');
+	return fclose(file) == 0;
+}
+
+int main(int argc, char** argv) {
+	const char* inName = nullptr; //inputs file
+	const char* outName = nullptr; //outputs file
+	const char* refName = nullptr; //reference outputs file
+	float tolerance = 1e-6f; //comparison tolerance (relative to max(1,|reference|))
+	size_t steps = 10000000; //timed steps
+	size_t reps = 5; //repetitions of the timed steps
+	double budget = 0; //max ns/step, 0 for none
+
+	int opt;
+	while ((opt = getopt(argc, argv, "i:o:c:e:n:k:b:h")) != -1) {
+		switch (opt) {
+		case 'i': inName = optarg; break;
+		case 'o': outName = optarg; break;
+		case 'c': refName = optarg; break;
+		case 'e': tolerance = strtof(optarg, nullptr); break;
+		case 'n': steps = strtoul(optarg, nullptr, 10); break;
+		case 'k': reps = strtoul(optarg, nullptr, 10); break;
+		case 'b': budget = strtod(optarg, nullptr); break;
+		default:
+			printf("Usage: %s [-i inputs.csv] [-o outputs.csv] [-c reference.csv] [-e tolerance] [-n steps] [-k repetitions] [-b max ns/step]\n", argv[0]);
+			return (opt == 'h') ? 0 : 1;
+		}
+	}
+	if ((steps == 0) || (reps == 0)) {
+		fprintf(stderr, "steps and repetitions must be positive\n");
+		return 1;
+	}
+
+	//recorded inputs, or sinusoids at different frequencies
+	std::vector<real32_T> in;
+	if (inName != nullptr) {
+		if (!readCsv(inName, NUM_INPUTS, in)) {
+			fprintf(stderr, "cannot read %zu inputs per line from %s\n", NUM_INPUTS, inName);
+			return 1;
+		}
+	} else {
+		for (size_t i = 0; i < 10000; i++) {
+			for (size_t c = 0; c < NUM_INPUTS; c++) in.push_back(sinf(0.001f * (c + 1) * i) + 0.1f * c);
+		}
+	}
+	size_t rows = in.size() / NUM_INPUTS;
+	std::vector<Inputs> inputs(rows);
+	memcpy(inputs.data(), in.data(), rows * sizeof(Inputs));
+
+	//results: one pass over the inputs from the initial state
+	ControlClass model;
+	ControlClass::begin();
+	std::vector<real32_T> out(rows * NUM_OUTPUTS);
+	for (size_t i = 0; i < rows; i++) {
+		model.setExternalInputs(&inputs[i]);
+		model.update();
+		memcpy(&out[i * NUM_OUTPUTS], &model.getExternalOutputs(), sizeof(Outputs));
+	}
+	if ((outName != nullptr) && !writeCsv(outName, NUM_OUTPUTS, out)) {
+		fprintf(stderr, "cannot write %s\n", outName);
+		return 1;
+	}
+
+	//timing: best of the repetitions, the inputs repeated over the steps
+	double best = INFINITY;
+	volatile real32_T sink = 0; //keep the outputs
+	for (size_t r = 0; r < reps; r++) {
+		uint64_t t0 = now();
+		for (size_t i = 0, k = 0; i < steps; i++) {
+			model.controlModel_U = inputs[k];
+			model.update();
+			if (++k == rows) k = 0;
+		}
+		real32_T last[NUM_OUTPUTS];
+		memcpy(last, &model.getExternalOutputs(), sizeof(Outputs));
+		for (size_t c = 0; c < NUM_OUTPUTS; c++) sink = sink + last[c];
+		best = std::min(best, (double) (now() - t0) / steps);
+	}
+	ControlClass::stop();
+
+	printf("model:       %zu inports, %zu outports, %zu input rows (%s)\n", NUM_INPUTS, NUM_OUTPUTS, rows, inName ? inName : "sinusoids");
+	printf("timing:      %zu steps x %zu repetitions, best %.2f ns/step, %.2f Msteps/s\n", steps, reps, best, 1e3 / best);
+	boolean ok = true;
+	if (budget > 0) {
+		ok = (best <= budget);
+		printf("budget:      %.2f ns/step, %s\n", budget, ok ? "ok" : "EXCEEDED");
+	}
+
+	//compare with the reference outputs
+	if (refName != nullptr) {
+		std::vector<real32_T> ref;
+		if (!readCsv(refName, NUM_OUTPUTS, ref) || (ref.size() != out.size())) {
+			fprintf(stderr, "cannot read %zu rows of %zu outputs from %s\n", rows, NUM_OUTPUTS, refName);
+			return 1;
+		}
+		double maxErr = 0;
+		size_t mismatches = 0;
+		for (size_t i = 0; i < out.size(); i++) {
+			double err = fabs((double) out[i] - ref[i]) / std::max(1.0, fabs((double) ref[i]));
+			if (!(err <= tolerance)) mismatches++; //NaN is a mismatch
+			if (err > maxErr) maxErr = err;
+		}
+		printf("results:     %zu/%zu outputs differ from %s, max error %.3g (tolerance %.3g), %s\n", mismatches, out.size(), refName, maxErr, tolerance, mismatches ? "FAILED" : "ok");
+		ok = ok && (mismatches == 0);
+	}
+	return ok ? 0 : 1;
+}
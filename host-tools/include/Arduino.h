@@ -0,0 +1,72 @@
+#ifndef _HOST_ARDUINO_H
+#define _HOST_ARDUINO_H
+
+/*! \file Arduino.h
+	\brief Minimal Arduino API for host builds.
+	\details The subset of the Arduino core used by the user-defined libraries (e.g. HostPort, SerialTransfer), 
+	so that they are compiled for the host PC without changes. Only Linux/POSIX is supported.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+typedef bool boolean; //!< Arduino boolean.
+typedef uint8_t byte; //!< Arduino byte.
+
+/*! \brief Microseconds.
+	\return The microseconds from the first call (monotonic clock).
+*/
+uint32_t micros(void);
+
+/*! \brief Milliseconds.
+	\return The milliseconds from the first call (monotonic clock).
+*/
+uint32_t millis(void);
+
+#define F(s) (s) //!< Flash string (a plain string on the host).
+
+/*! \brief Base class for writing bytes.
+	\details As the Arduino Print, with only the formatting of strings and decimal integers.
+*/
+class Print {
+public:
+	virtual ~Print() { }
+	virtual size_t write(uint8_t b) = 0; //!< Write a byte.
+	virtual size_t write(const uint8_t* buffer, size_t size); //!< Write bytes.
+	virtual int availableForWrite(void) { return 0; } //!< Bytes that can be written without blocking.
+	virtual void flush(void) { } //!< Wait until all bytes are written.
+	size_t print(const char* s) { return write((const uint8_t*) s, strlen(s)); } //!< Write a string.
+	size_t print(long n); //!< Write a decimal integer.
+	size_t println(const char* s = "") { return print(s) + print("\r\n"); } //!< Write a string and a newline.
+	size_t println(long n) { return print(n) + print("\r\n"); } //!< Write a decimal integer and a newline.
+};
+
+/*! \brief Base class for byte streams.
+	\details As the Arduino Stream, without the parsing functions.
+*/
+class Stream : public Print {
+public:
+	virtual int available() = 0; //!< Bytes available for reading.
+	virtual int read() = 0; //!< Read a byte, -1 if none.
+	virtual int peek() = 0; //!< Next byte without reading it, -1 if none.
+	size_t readBytes(uint8_t* buffer, size_t length); //!< Read bytes, stop when no byte is available.
+	size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*) buffer, length); } //!< Read bytes, stop when no byte is available.
+};
+
+/*! \brief Standard output as a Stream.
+	\details The default debug port (e.g. of SerialTransfer): bytes are written to stdout and none is read.
+*/
+class StdoutStream : public Stream {
+public:
+	size_t write(uint8_t b) override; //!< Write a byte.
+	size_t write(const uint8_t* buffer, size_t size) override; //!< Write bytes.
+	int available() override { return 0; } //!< Bytes available for reading (none).
+	int read() override { return -1; } //!< Read a byte (none).
+	int peek() override { return -1; } //!< Next byte (none).
+};
+
+extern StdoutStream Serial; //!< Serial monitor.
+
+#endif
@@ -0,0 +1,54 @@
+#include "Arduino.h"
+
+#include <stdio.h>
+#include <time.h>
+
+StdoutStream Serial;
+
+//monotonic time in ns from the first call
+static uint64_t nanos() {
+	static uint64_t t0 = 0;
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	uint64_t t = (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+	if (t0 == 0) t0 = t;
+	return t - t0;
+}
+
+uint32_t micros(void) {
+	return (uint32_t) (nanos() / 1000);
+}
+
+uint32_t millis(void) {
+	return (uint32_t) (nanos() / 1000000);
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+	size_t count = 0;
+	while (size--) count += write(*buffer++);
+	return count;
+}
+
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+	size_t count = 0;
+	while (count < length) {
+		int c = read();
+		if (c < 0) break; //no more bytes
+		buffer[count++] = (uint8_t) c;
+	}
+	return count;
+}
+
+size_t Print::print(long n) {
+	char buf[24];
+	int len = snprintf(buf, sizeof(buf), "%ld", n);
+	return write((const uint8_t*) buf, len);
+}
+
+size_t StdoutStream::write(uint8_t b) {
+	return fwrite(&b, 1, 1, stdout);
+}
+
+size_t StdoutStream::write(const uint8_t* buffer, size_t size) {
+	return fwrite(buffer, 1, size, stdout);
+}
@@ -0,0 +1,112 @@
+#include "FdStream.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+//Constructor
+FdStream::FdStream(int fd) {
+	_fd = fd;
+}
+
+//Open serial port
+int FdStream::openSerial(const char* path, unsigned int baud) {
+	int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (fd < 0) { //cannot open
+		return -1;
+	}
+	struct termios tio;
+	if (tcgetattr(fd, &tio) != 0) { //not a tty
+		close(fd);
+		return -1;
+	}
+	cfmakeraw(&tio); //no echo, no line processing
+	cfsetispeed(&tio, baud);
+	cfsetospeed(&tio, baud);
+	tio.c_cflag |= CLOCAL | CREAD;
+	if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+		close(fd);
+		return -1;
+	}
+	tcflush(fd, TCIOFLUSH); //discard old bytes
+	return fd;
+}
+
+//Open pty
+boolean FdStream::openPty(int* master, int* slave) {
+	int m = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (m < 0) {
+		return false;
+	}
+	if ((grantpt(m) != 0) || (unlockpt(m) != 0)) {
+		close(m);
+		return false;
+	}
+	int s = open(ptsname(m), O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (s < 0) {
+		close(m);
+		return false;
+	}
+	struct termios tio;
+	tcgetattr(s, &tio);
+	cfmakeraw(&tio); //no echo, no line processing
+	tcsetattr(s, TCSANOW, &tio);
+	*master = m;
+	*slave = s;
+	return true;
+}
+
+void FdStream::fill() {
+	if (_head == _tail) { //buffer empty, restart from the beginning
+		_head = 0;
+		_tail = 0;
+	}
+	if (_tail < BUF_SIZE) {
+		ssize_t n = ::read(_fd, _buf + _tail, BUF_SIZE - _tail);
+		if (n > 0) _tail += n;
+	}
+}
+
+int FdStream::available() {
+	fill();
+	return (int) (_tail - _head);
+}
+
+int FdStream::read() {
+	if ((_head == _tail) && (available() == 0)) { //nothing to read
+		return -1;
+	}
+	return _buf[_head++];
+}
+
+int FdStream::peek() {
+	if ((_head == _tail) && (available() == 0)) { //nothing to read
+		return -1;
+	}
+	return _buf[_head];
+}
+
+size_t FdStream::write(uint8_t b) {
+	return write(&b, 1);
+}
+
+size_t FdStream::write(const uint8_t* buffer, size_t size) {
+	size_t count = 0;
+	while (count < size) {
+		ssize_t n = ::write(_fd, buffer + count, size - count);
+		if (n > 0) {
+			count += n;
+		}
+		else if ((n < 0) && (errno == EAGAIN)) { //wait until writable
+			struct pollfd pfd = { _fd, POLLOUT, 0 };
+			poll(&pfd, 1, 100);
+		}
+		else if ((n < 0) && (errno != EINTR)) { //error
+			break;
+		}
+	}
+	return count;
+}
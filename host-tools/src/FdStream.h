@@ -0,0 +1,61 @@
+#ifndef _FDSTREAM_H
+#define _FDSTREAM_H
+
+#include "Arduino.h"
+
+/*! \brief A Stream over a POSIX file descriptor.
+	\details The class makes a serial port, a pty or any other file descriptor usable as the Stream of HostPort on the host PC.
+	Reads are non-blocking, as on the micro-controller, and writes block until all bytes are written.
+
+	```c++
+	int fd = FdStream::openSerial("/dev/ttyACM0", B2000000);
+	FdStream serial(fd);
+	HostPort hostPort(&serial, header, terminator);
+	```
+
+	\see HostPort
+*/
+class FdStream : public Stream {
+public:
+	/*! \brief Contructor.
+		\param fd The file descriptor, opened with O_NONBLOCK.
+	*/
+	explicit FdStream(int fd);
+
+	/*! \brief Open a serial port.
+		\details The function opens a serial port in raw mode, non-blocking.
+		\param path The path of the serial port, e.g. /dev/ttyACM0.
+		\param baud The baudrate as a termios constant (e.g. B115200). Ignored by USB serial ports.
+		\return The file descriptor, -1 on error.
+	*/
+	static int openSerial(const char* path, unsigned int baud);
+
+	/*! \brief Open a pty.
+		\details The function opens a pseudo-terminal in raw mode, non-blocking on both sides.
+		\param master The file descriptor of the master side.
+		\param slave The file descriptor of the slave side.
+		\return True if success.
+	*/
+	static boolean openPty(int* master, int* slave);
+
+	int available() override; //!< Bytes available for reading, without waiting.
+	int read() override; //!< Read a byte, -1 if none.
+	int peek() override; //!< Next byte without reading it, -1 if none.
+	size_t write(uint8_t b) override; //!< Write a byte.
+	size_t write(const uint8_t* buffer, size_t size) override; //!< Write bytes, waiting until all bytes are written.
+
+	static constexpr size_t BUF_SIZE = 4096; //!< Receive buffer size.
+
+private:
+	/*! \brief Fill the receive buffer.
+		\details The function reads the bytes available in the file descriptor, without waiting.
+	*/
+	void fill(void);
+
+	uint8_t _buf[BUF_SIZE]; //!< Receive buffer.
+	size_t _head = 0; //!< Index of the next byte to read.
+	size_t _tail = 0; //!< Number of bytes in the receive buffer.
+	int _fd = -1; //!< File descriptor.
+};
+
+#endif
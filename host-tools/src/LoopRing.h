@@ -0,0 +1,45 @@
+#ifndef _LOOPRING_H
+#define _LOOPRING_H
+
+#include "Arduino.h"
+#include "HostRing.h"
+
+/*! \brief An in-memory receive ring.
+	\details The class is a stub of the DMA receive ring for tests and benchmarks without a board: bytes written as a Stream
+	are copied in the ring, as done by the DMA channel of HostUart, and read back by HostPort::read() from the ring.
+	\tparam N The ring size (bytes), power of 2.
+*/
+template <size_t N = 65536>
+class LoopRing : public Stream, public HostRing {
+public:
+	LoopRing() : HostRing(_ring, N) { } //!< Constructor.
+	int available() override { update(); return (int) HostRing::available(); } //!< Bytes available for reading.
+	int read() override { return (available() > 0) ? get() : -1; } //!< Read a byte, -1 if none.
+	int peek() override { return (available() > 0) ? _ring[_tail] : -1; } //!< Next byte without reading it, -1 if none.
+	size_t write(uint8_t b) override { return write(&b, 1); } //!< Write a byte.
+
+	/*! \brief Write bytes.
+		\details The function copies the bytes in the ring, dropping them if the ring is full.
+		\param buffer The bytes.
+		\param size The number of bytes.
+		\return The number of bytes written.
+	*/
+	size_t write(const uint8_t* buffer, size_t size) override {
+		size_t room = N - 1 - ((_pos - _tail) & _mask); //bytes not read yet are kept
+		if (size > room) size = room;
+		for (size_t i = 0; i < size; i++) {
+			_ring[(_pos + i) & _mask] = buffer[i];
+		}
+		_pos = (_pos + size) & _mask;
+		return size;
+	}
+
+	int availableForWrite(void) override { return (int) (N - 1 - ((_pos - _tail) & _mask)); } //!< Bytes that can be written.
+	size_t head(void) override { return _pos; } //!< Producer position.
+
+private:
+	volatile uint8_t _ring[N]; //!< Ring buffer.
+	size_t _pos = 0; //!< Producer position.
+};
+
+#endif
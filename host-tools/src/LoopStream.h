@@ -0,0 +1,54 @@
+#ifndef _LOOPSTREAM_H
+#define _LOOPSTREAM_H
+
+#include "Arduino.h"
+
+/*! \brief An in-memory Stream.
+	\details The class is a stub of the serial for tests and benchmarks without a board: bytes written are read back from the same object.
+	Two LoopStream objects, one per direction, connect a device-side and a host-side HostPort.
+	\tparam N The buffer size (bytes).
+*/
+template <size_t N = 65536>
+class LoopStream : public Stream {
+public:
+	int available() override { return (int) (_tail - _head); } //!< Bytes available for reading.
+	int read() override { return (_head < _tail) ? _buf[_head++] : -1; } //!< Read a byte, -1 if none.
+	int peek() override { return (_head < _tail) ? _buf[_head] : -1; } //!< Next byte without reading it, -1 if none.
+	size_t write(uint8_t b) override { return write(&b, 1); } //!< Write a byte.
+
+	/*! \brief Write bytes.
+		\details The function appends the bytes, dropping them if the buffer is full.
+		\param buffer The bytes.
+		\param size The number of bytes.
+		\return The number of bytes written.
+	*/
+	size_t write(const uint8_t* buffer, size_t size) override {
+		if (_head == _tail) { //buffer empty, restart from the beginning
+			_head = 0;
+			_tail = 0;
+		}
+		if (size > (N - _tail)) { //compact the buffer
+			memmove(_buf, _buf + _head, _tail - _head);
+			_tail -= _head;
+			_head = 0;
+		}
+		if (size > (N - _tail)) { //buffer full
+			size = N - _tail;
+		}
+		memcpy(_buf + _tail, buffer, size);
+		_tail += size;
+		_writes++;
+		return size;
+	}
+
+	int availableForWrite(void) override { return (int) (N - (_tail - _head)); } //!< Bytes that can be written.
+	size_t writes() const { return _writes; } //!< Number of write calls.
+
+private:
+	uint8_t _buf[N]; //!< Buffer.
+	size_t _head = 0; //!< Index of the next byte to read.
+	size_t _tail = 0; //!< Number of bytes in the buffer.
+	size_t _writes = 0; //!< Number of write calls.
+};
+
+#endif
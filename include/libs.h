@@ -14,5 +14,10 @@
 #include <T4_PowerButton.h> //for on/off button management https://github.com/FrankBoesing/T4_PowerButton/blob/master/examples/power/power.ino
 #include <SD.h> //for saving in SD, includes SDFat
 #include <controlModel.h> //include control model librariy (generated with the Embedeed coder)
+#include <controlModel_rates.h> //include rates of the control model (generated with gencode)
+#include <controlModel_params.h> //include fields of the control model parameters (generated with gencode)
+#include <RateScheduler.h> //for periodic tasks from timer interrupts
+#include <ModelBinding.h> //for bindings between drivers and control model
+#include <ParamService.h> //for online tuning of the control model parameters
 
 #endif
@@ -1,5 +1,6 @@
 
 #include "HostPort.h"
+#include "PacketCRC.h" //CRC-16 and CRC-32 kernels and tables of SerialTransfer
 
 #if ARDUINO >= 100
 #include "Arduino.h"
@@ -7,6 +8,8 @@
 #include "WProgram.h"
 #endif
 
+#define BARRIER() __asm__ __volatile__("" ::: "memory") //compiler barrier, no reordering of memory accesses across this
+
 //Constructors
 HostPort::HostPort(Stream* serial, uint32_t start_bytes, uint32_t stop_bytes) {
 	init(); //general init
@@ -31,71 +34,138 @@ void HostPort::init(void) {
 	//reset vars
 	_header = 0;
 	_terminator = 0;
-	_numObj_rx = 0;
-	_numObj_tx = 0;
-	_totSize_tx = 0;
+	for (uint8_t i = 0; i < MAX_IDS; i++) {
+		_numObj_rx[i] = 0;
+		_numObj_tx[i] = 0;
+		_totSize_rx[i] = 0;
+		_totSize_tx[i] = 0;
+		_callback_rx[i] = nullptr;
+	}
+	resetrx();
+	resetStats();
 }
 
 //Attach functions
 boolean HostPort::attachRx(uint8_t* pointer, size_t size) { //attach for rx
-	if (_numObj_rx >= MAX_OBJS) { //max MAX_OBJS objects can be attached
+	return attachRx(0, pointer, size); //default message ID
+}
+
+boolean HostPort::attachTx(uint8_t* pointer, size_t size) { //attach for tx
+	return attachTx(0, pointer, size); //default message ID
+}
+
+boolean HostPort::attachRx(uint8_t id, uint8_t* pointer, size_t size) { //attach for rx with message ID
+	if (id >= MAX_IDS) { //message ID not valid
+		return false;
+	}
+	if (_callback_rx[id] != nullptr) { //message ID already dispatched to a callback
 		return false;
 	}
-	if ((_totSize_rx + size) > (BUF_SIZE - 8)) { //tot bytes to receive greater than BUF_SIZE (8 bytes are for header and terminator bytes)
+	if (_numObj_rx[id] >= MAX_OBJS) { //max MAX_OBJS objects can be attached
 		return false;
 	}
-	_ptr_rx[_numObj_rx] = pointer; //assign pointer
-	_size_rx[_numObj_rx] = size; //assign size
-	_numObj_rx++; //increase num of attached objects
-	_totSize_rx += size; //increase tot rx bytes
+	if ((_totSize_rx[id] + size) > maxdata(_crc, prefix())) { //tot bytes to receive greater than BUF_SIZE (8 bytes are for header and terminator bytes, others for CRC and message ID)
+		return false;
+	}
+	_ptr_rx[id][_numObj_rx[id]] = pointer; //assign pointer
+	_size_rx[id][_numObj_rx[id]] = size; //assign size
+	_numObj_rx[id]++; //increase num of attached objects
+	_totSize_rx[id] += size; //increase tot rx bytes
 	return true; //return true
 }
 
-boolean HostPort::attachTx(uint8_t* pointer, size_t size) { //attach for tx
-	if (_numObj_tx >= MAX_OBJS) { //max MAX_OBJS objects can be attached
+boolean HostPort::attachTx(uint8_t id, uint8_t* pointer, size_t size) { //attach for tx with message ID
+	if (id >= MAX_IDS) { //message ID not valid
+		return false;
+	}
+	if (_numObj_tx[id] >= MAX_OBJS) { //max MAX_OBJS objects can be attached
 		return false;
 	}
-	if ((_totSize_tx + size) > (BUF_SIZE - 8)) { //tot bytes to send greater than BUF_SIZE (8 bytes are for header and terminator bytes)
+	if ((_totSize_tx[id] + size) > maxdata(_crc, prefix())) { //tot bytes to send greater than BUF_SIZE (8 bytes are for header and terminator bytes, others for CRC and message ID)
 		return false;
 	}
-	_ptr_tx[_numObj_tx] = pointer; //assign pointer
-	_size_tx[_numObj_tx] = size; //assign size
-	_numObj_tx++; //increase num of attached objects
-	_totSize_tx += size; //increase tot tx bytes
+	_ptr_tx[id][_numObj_tx[id]] = pointer; //assign pointer
+	_size_tx[id][_numObj_tx[id]] = size; //assign size
+	_numObj_tx[id]++; //increase num of attached objects
+	_totSize_tx[id] += size; //increase tot tx bytes
+	return true; //return true
+}
+
+boolean HostPort::attachRx(uint8_t id, Callback callback, size_t size) { //dispatch rx message ID to callback
+	if (id >= MAX_IDS) { //message ID not valid
+		return false;
+	}
+	if (_numObj_rx[id] != 0) { //objects already attached to the message ID
+		return false;
+	}
+	if (size > maxdata(_crc, prefix())) { //bytes to receive greater than BUF_SIZE
+		return false;
+	}
+	_callback_rx[id] = callback; //assign callback
+	_totSize_rx[id] = (callback != nullptr) ? size : 0; //assign size
 	return true; //return true
 }
 
 //write data to serial
 boolean HostPort::write() {
+	return write(0); //default message ID
+}
+
+//write data to serial with message ID
+boolean HostPort::write(uint8_t id) {
 	if (!(_serial)) { //serial not available
 		return false;
 	}
-	if (_numObj_tx == 0) { //nothing to transmit
+	if (id >= (_ids ? MAX_IDS : 1)) { //message ID not valid
+		return false;
+	}
+	if (!_ids && (_numObj_tx[0] == 0)) { //nothing to transmit
 		return false;
 	}
 
-	uint8_t c = 0; //index counter for buf (global counter)
+	if (_gather) { //gather-write, no copy in _tx_buf
+		return writegather(id);
+	}
+
+	size_t c = 0; //index counter for buf (global counter)
 
 	//put start bytes in buf if necessary
-	//note that c++ return the current value of c, and then increment c, e.g. if c=4, _tx_buf[c++] returns _tx_buf[0] and puts c=1
 	if (_header != 0) {
-		_tx_buf[c++] = _header & MASK;
-		_tx_buf[c++] = (_header >> 8) & MASK;
-		_tx_buf[c++] = (_header >> 16) & MASK;
-		_tx_buf[c++] = (_header >> 24) & MASK;
+		put32(_tx_buf + c, _header);
+		c += 4;
+	}
+	size_t start = c; //first byte of the CRC
+
+	//put message ID in buf if necessary
+	if (_ids) {
+		_tx_buf[c++] = id;
+	}
+
+	//put timestamps in buf if necessary
+	if (_ts) {
+		put32(_tx_buf + c, micros()); //transmit time
+		put32(_tx_buf + c + 4, _rx_peer); //echo of the peer transmit time
+		c += 8;
+	}
+
+	//put attached objects in buf, one memcpy per object
+	for (uint8_t j = 0; j < _numObj_tx[id]; j++) {
+		memcpy(_tx_buf + c, _ptr_tx[id][j], _size_tx[id][j]); //get the data stored in RAM address
+		c += _size_tx[id][j];
 	}
 
-	//put each byte of attached objects in buf
-	for (uint8_t j = 0; j < _numObj_tx; j++) {
-		for (uint8_t k = 0; k < _size_tx[j]; k++) _tx_buf[c++] = *(_ptr_tx[j] + k); //get the data stored in RAM address
+	//put CRC bytes in buf if necessary
+	if (_crc != 0) {
+		uint8_t bytes[4];
+		put32(bytes, crcfinal(crcupdate(crcinit(), _tx_buf + start, c - start)));
+		memcpy(_tx_buf + c, bytes, _crc);
+		c += _crc;
 	}
 
 	//put stop bytes in buf if necessary
 	if (_terminator != 0) {
-		_tx_buf[c++] = _terminator & MASK;
-		_tx_buf[c++] = (_terminator >> 8) & MASK;
-		_tx_buf[c++] = (_terminator >> 16) & MASK;
-		_tx_buf[c++] = (_terminator >> 24) & MASK;
+		put32(_tx_buf + c, _terminator);
+		c += 4;
 	}
 
 	//write buf to serial
@@ -106,74 +176,369 @@ boolean HostPort::write() {
 	return true; //all is ok
 }
 
+//write data to serial directly from the attached objects
+boolean HostPort::writegather(uint8_t id) {
+	uint8_t bytes[4]; //header or terminator bytes
+
+	if (_header != 0) { //write start bytes if necessary
+		put32(bytes, _header);
+		_serial->write(bytes, 4);
+	}
+
+	uint32_t crc = crcinit();
+	if (_ids) { //write message ID if necessary
+		_serial->write(&id, 1);
+		if (_crc != 0) crc = crcupdate(crc, &id, 1);
+	}
+
+	if (_ts) { //write timestamps if necessary
+		uint8_t ts[8];
+		put32(ts, micros()); //transmit time
+		put32(ts + 4, _rx_peer); //echo of the peer transmit time
+		_serial->write(ts, 8);
+		if (_crc != 0) crc = crcupdate(crc, ts, 8);
+	}
+
+	for (uint8_t j = 0; j < _numObj_tx[id]; j++) { //write each attached object in bulk
+		_serial->write(_ptr_tx[id][j], _size_tx[id][j]);
+		if (_crc != 0) crc = crcupdate(crc, _ptr_tx[id][j], _size_tx[id][j]);
+	}
+
+	if (_crc != 0) { //write CRC bytes if necessary
+		put32(bytes, crcfinal(crc));
+		_serial->write(bytes, _crc);
+	}
+
+	if (_terminator != 0) { //write stop bytes if necessary
+		put32(bytes, _terminator);
+		_serial->write(bytes, 4);
+	}
+	return true; //all is ok
+}
+
+//enable or disable the gather-write
+void HostPort::setGatherWrite(boolean enable) {
+	_gather = enable;
+}
+
 //read data from serial
 boolean HostPort::read() {
 	if (!(_serial)) { //serial not available
 		return false;
 	}
 
-	if (_numObj_rx == 0) { //nothing to receive
+	if (!_ids && !rxattached(0)) { //nothing to receive
 		return false;
 	}
 
-	if (!(_serial->available())) { //no available data
-		return false;
+	if (_ring != nullptr) { //bytes received so far in the ring
+		uint32_t overflows = _ring->overflows();
+		_ring->update();
+		if ((_ring->overflows() != overflows) && (_rx_state != 0)) { //bytes lost, partial packet corrupted
+			_stats.overflows++;
+			resetrx();
+		}
 	}
 
-	uint8_t c = 0; //counter
-	uint32_t time0 = micros(); //start time for timeout
-
-	if (_header == 0) c = 4; //put i directly to 4 if no start bytes
+	if ((_timeout != 0) && (_rx_state != 0) && ((micros() - _rx_t0) > _timeout)) { //partial packet too old, discard it
+		_stats.timeouts++;
+		resetrx();
+	}
 
-	while ((micros() - time0) <= TIMEOUT_HOSTPORT) { //check timeout TIMEOUT_HOSTPORT
-		if (_serial->available()) { //do stuff if serial data available 
-			if (c < 4) { 
-				if (_serial->read() == ((_header >> (8 * c)) & MASK)) { //read and compare to _header
-					c++; //increment c if read is ok
-					continue; //start new cycle as soon as data are available 
-				}
+	int avail; //num of bytes available in the serial buffer (or still to replay)
+	while ((avail = rxavailable()) > 0) { //consume only the bytes already available, never wait
+		if (_rx_state < 4) { //looking for the header
+			if (_header == 0) { //no header, go directly to the data
+				_rx_state = 4;
+				_rx_t0 = micros(); //arrival time of the first byte
+				continue;
+			}
+			_rx_state = hdrmatch(_header, _rx_state, rxbyte()); //compare to _header, restart from the longest partial header on a mismatch
+			if (_rx_state == 1) { //first header byte
+				_rx_t0 = micros(); //arrival time of the first byte
 			}
-			else if (c == 4) { //read actual data
-	
-				/*for (uint8_t j = 0; j < _numObj_rx; j++) {
-					if (_size_rx[j] != _serial->readBytes(_ptr_rx[j], _size_rx[j])) { //read for each attached rx objects and check size of data received
-						return false; //return false if data size not consistent
-					}
-				}*/
-				if (_totSize_rx != _serial->readBytes(_rx_buf, _totSize_rx)) { //read and save in buffer
-							return false; //return false if data size not consistent
+		}
+		else if (_rx_state == 4) { //read message ID and actual data
+			if (_ids && (_rx_idx == 0)) { //message ID first, saved in the buffer before the data
+				_rx_back[_rx_idx++] = rxbyte();
+				avail--;
+				if ((_rx_back[0] >= MAX_IDS) || !rxattached(_rx_back[0])) { //unknown message ID, discard packet
+					_stats.idErrors++;
+					if (rxfail()) continue; //resync in the remaining bytes
+					return false; //sth wrong
 				}
-
-				if (_terminator == 0) { //if _terminator==0 all is ok
-					copyrx(); //copy buffer in rx objects
-					return true; //all is ok
+			}
+			size_t len = _totSize_rx[_ids ? _rx_back[0] : 0] + prefix(); //bytes of message ID, timestamps and data
+			size_t n = len - _rx_idx; //bytes still missing
+			if ((size_t) avail < n) n = avail; //read only what is available, so that readBytes does not block
+			_rx_idx += rxbytes(_rx_back + _rx_idx, n); //read and save in buffer
+			if (_rx_idx < len) { //data not complete yet
+				continue;
+			}
+			if ((_crc == 0) && (_terminator == 0)) { //no trailer, all is ok
+				resetrx(); //ready for next packet
+				rxdone(); //copy buffer in rx objects or flip buffers
+				return true; //all is ok
+			}
+			_rx_state++; //data read, go to CRC and terminator
+		}
+		else { //_rx_state == 5, all data read
+			uint8_t b = rxbyte();
+			_rx_trail[_rx_tidx++] = b; //save trailer byte
+			if (_rx_tidx > _crc) { //check stop bytes
+				if (b != ((_terminator >> (8 * (_rx_tidx - _crc - 1))) & MASK)) { //wrong terminator, discard packet
+					_stats.terminatorErrors++;
+					if (rxfail()) continue; //resync in the remaining bytes
+					return false; //sth wrong
 				}
-
-				c++; //increment c when reading finished
-				continue; //start new cycle
 			}
-			else { //c > 4, all data read 
-				if (_serial->read() == ((_terminator >> (8 * (c - 5))) & MASK)) { //check stop bytes
-					c++;  //increment c if read byte is ok
-					if (c == 9) { //if c=9 all stop bytes read ok
-						copyrx(); //copy buffer in rx objects
-						return true; //all ok
-					}
-					else { 
-						continue; //if c<9 (and c>4) start new cycle and read as soon as data available
-					} 
+			else if (_rx_tidx == _crc) { //check CRC
+				uint32_t crc = 0; //received CRC, LSB first
+				for (uint8_t k = 0; k < _crc; k++) crc |= ((uint32_t) _rx_trail[k]) << (8 * k);
+				if (crc != crcfinal(crcupdate(crcinit(), _rx_back, _rx_idx))) { //wrong CRC, discard packet
+					_stats.crcErrors++;
+					if (rxfail()) continue; //resync in the remaining bytes
+					return false; //sth wrong
 				}
 			}
-			return false; //sth wrong
+			if (_rx_tidx == (_crc + ((_terminator != 0) ? 4 : 0))) { //all CRC and stop bytes read ok
+				resetrx(); //ready for next packet
+				rxdone(); //copy buffer in rx objects or flip buffers
+				return true; //all ok
+			}
 		}
 	}
-	return false; //sth wrong
+	return false; //packet not complete yet
+}
+
+//enable or disable the CRC
+boolean HostPort::setCrc(uint8_t type) {
+	if ((type != NO_CRC) && (type != CRC16) && (type != CRC32)) { //CRC not supported
+		return false;
+	}
+	if (!fits(type, prefix())) { //attached objects and CRC greater than BUF_SIZE
+		return false;
+	}
+	_crc = type;
+	resetrx(); //packet layout changed
+	return true;
+}
+
+//enable or disable the message IDs
+boolean HostPort::setIds(boolean enable) {
+	if (!fits(_crc, (enable ? 1 : 0) + (_ts ? 8 : 0))) { //attached objects and message ID greater than BUF_SIZE
+		return false;
+	}
+	_ids = enable;
+	resetrx(); //packet layout changed
+	return true;
+}
+
+//ID of the latest received message
+uint8_t HostPort::rxId() const {
+	return _rx_id;
+}
+
+//enable or disable the timestamps
+boolean HostPort::setTimestamps(boolean enable) {
+	if (!fits(_crc, (_ids ? 1 : 0) + (enable ? 8 : 0))) { //attached objects and timestamps greater than BUF_SIZE
+		return false;
+	}
+	_ts = enable;
+	resetrx(); //packet layout changed
+	return true;
+}
+
+//set the timeout of partial packets
+void HostPort::setTimeout(uint32_t timeout) {
+	_timeout = timeout;
+}
+
+//reset the statistics
+void HostPort::resetStats() {
+	memset(&_stats, 0, sizeof(_stats));
+	_stats.parseMin = UINT32_MAX;
+}
+
+//enable or disable the resync
+void HostPort::setResync(uint8_t* buffer) {
+	_rp_buf = buffer;
+	_rp_len = 0; //nothing to replay in the new buffer
+	_rp_pos = 0;
+}
+
+void HostPort::resetrx() {
+	_rx_state = 0;
+	_rx_idx = 0;
+	_rx_tidx = 0;
+}
+
+boolean HostPort::rxfail() {
+	if (_rp_buf != nullptr) { //parse again the packet bytes after its first byte
+		_stats.resyncs++;
+		replay();
+	}
+	resetrx(); //discard packet
+	return _rp_buf != nullptr;
+}
+
+void HostPort::replay() {
+	size_t left = _rp_len - _rp_pos; //bytes not replayed yet
+	size_t k = 0; //index counter for the replay buffer
+	if (_header != 0) k += 4;
+	k += _rx_idx + _rx_tidx; //size of the discarded packet
+	memmove(_rp_buf + k, _rp_buf + _rp_pos, left); //keep the bytes not replayed yet after the packet
+	_rp_len = k + left;
+	k = 0;
+	if (_header != 0) { //header bytes
+		put32(_rp_buf, _header);
+		k += 4;
+	}
+	memcpy(_rp_buf + k, _rx_back, _rx_idx); //data bytes
+	k += _rx_idx;
+	memcpy(_rp_buf + k, _rx_trail, _rx_tidx); //CRC and stop bytes
+	_rp_pos = 1; //skip the first byte of the discarded packet
+}
+
+int HostPort::rxavailable() {
+	if (_rp_pos < _rp_len) { //replay first
+		return _rp_len - _rp_pos;
+	}
+	if (_ring != nullptr) { //bytes from the ring, no virtual call
+		return (int) _ring->available();
+	}
+	return _serial->available();
+}
+
+uint8_t HostPort::rxbyte() {
+	if (_rp_pos < _rp_len) { //replay first
+		return _rp_buf[_rp_pos++];
+	}
+	if (_ring != nullptr) { //bytes from the ring, no virtual call
+		return _ring->get();
+	}
+	return _serial->read();
+}
+
+size_t HostPort::rxbytes(uint8_t* buf, size_t len) {
+	if (_rp_pos < _rp_len) { //replay first, len is never greater than rxavailable()
+		memcpy(buf, _rp_buf + _rp_pos, len);
+		_rp_pos += len;
+		return len;
+	}
+	if (_ring != nullptr) { //bytes from the ring, no virtual call
+		return _ring->get(buf, len);
+	}
+	return _serial->readBytes(buf, len);
+}
+
+uint32_t HostPort::crcinit() const {
+	return (_crc == CRC32) ? 0xFFFFFFFF : 0xFFFF;
+}
+
+uint32_t HostPort::crcupdate(uint32_t crc, const uint8_t* buf, size_t len) const {
+	if (_crc == CRC16) { //CRC-16/CCITT-FALSE, MSB first
+		return PacketCRC::crc16(buf, len, crc);
+	}
+	return ~PacketCRC::crc32(buf, len, ~crc); //CRC-32, reflected, final xor applied by crcfinal()
+}
+
+uint32_t HostPort::crcfinal(uint32_t crc) const {
+	return (_crc == CRC32) ? ~crc : crc;
+}
+
+//set the receive ring
+void HostPort::setRing(HostRing* ring) {
+	_ring = ring;
+	resetrx(); //restart parsing from the ring
+}
+
+//enable or disable the double-buffered receive
+void HostPort::setDoubleBuffer(uint8_t* buffer) {
+	_dbuf = (buffer != nullptr);
+	_rx_buf2 = buffer;
+	_rx_back = _rx_buf;
+	_rx_front = _rx_buf2;
+	_rx_ready = false; //no packet in the front buffer yet
+	resetrx(); //restart parsing in the new back buffer
 }
 
-void HostPort::copyrx() {
-	uint8_t k = 0;
-	for (uint8_t j = 0; j < _numObj_rx; j++) {
-		memcpy(_ptr_rx[j], ((uint8_t*)_rx_buf + k), _size_rx[j]);
-		k += _size_rx[j];
+//copy the latest received packet in the rx objects
+uint32_t HostPort::snapshot() {
+	uint32_t seq;
+	if (!_rx_ready) { //no packet in the front buffer yet
+		return _rx_seq;
+	}
+	do {
+		seq = _rx_seq; //sequence before the copy
+		BARRIER();
+		copyrx(_rx_front);
+		BARRIER();
+	} while (seq != _rx_seq); //buffers flipped during the copy, copy again
+	return seq;
+}
+
+void HostPort::rxdone() {
+	uint32_t dt = micros() - _rx_t0; //parse duration, from the first byte
+	if (dt < _stats.parseMin) _stats.parseMin = dt;
+	if (dt > _stats.parseMax) _stats.parseMax = dt;
+	uint8_t bin = (dt == 0) ? 0 : (32 - __builtin_clz(dt)); //log2 bin
+	_stats.parseHist[(bin < HIST_BINS) ? bin : (HIST_BINS - 1)]++;
+	_stats.ok++;
+
+	_rx_arrival = _rx_t0;
+	if (_ts) { //timestamps after the message ID
+		const uint8_t* ts = _rx_back + (_ids ? 1 : 0);
+		_rx_peer = ts[0] | (ts[1] << 8) | (ts[2] << 16) | ((uint32_t) ts[3] << 24);
+		_rx_echo = ts[4] | (ts[5] << 8) | (ts[6] << 16) | ((uint32_t) ts[7] << 24);
+	}
+
+	uint8_t id = _ids ? _rx_back[0] : 0; //message ID
+	if (_callback_rx[id] != nullptr) { //dispatch to the callback
+		_rx_id = id;
+		_callback_rx[id](id, _rx_back + prefix(), _totSize_rx[id]);
+	}
+	else if (_dbuf) { //flip front and back buffers
+		uint8_t* front = _rx_back;
+		_rx_back = _rx_front;
+		BARRIER(); //packet data must be complete before publishing it
+		_rx_front = front; //single pointer write
+		_rx_ready = true;
+	}
+	else {
+		copyrx(_rx_back);
+	}
+	_rx_seq++;
+}
+
+void HostPort::copyrx(const uint8_t* buf) {
+	uint8_t id = _ids ? buf[0] : 0; //message ID saved before the data
+	buf += prefix(); //skip message ID and timestamps
+	size_t k = 0;
+	for (uint8_t j = 0; j < _numObj_rx[id]; j++) {
+		memcpy(_ptr_rx[id][j], buf + k, _size_rx[id][j]);
+		k += _size_rx[id][j];
+	}
+	_rx_id = id;
+}
+
+boolean HostPort::rxattached(uint8_t id) const {
+	return (_numObj_rx[id] != 0) || (_callback_rx[id] != nullptr);
+}
+
+size_t HostPort::prefix() const {
+	return (_ids ? 1 : 0) + (_ts ? 8 : 0);
+}
+
+size_t HostPort::maxdata(uint8_t crc, size_t prefix) const {
+	return BUF_SIZE - 8 - crc - prefix;
+}
+
+boolean HostPort::fits(uint8_t crc, size_t prefix) const {
+	for (uint8_t i = 0; i < MAX_IDS; i++) {
+		if ((_totSize_rx[i] > maxdata(crc, prefix)) || (_totSize_tx[i] > maxdata(crc, prefix))) {
+			return false;
+		}
 	}
+	return true;
 }
\ No newline at end of file
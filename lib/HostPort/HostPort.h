@@ -8,11 +8,16 @@
 #include "WProgram.h"
 #endif
 
+#include "HostRing.h"
+
 /*! \brief A class for communication with PC via USB/serial.
 	\details The class manages the communication between a microcontroller and 
 	a host PC via USB/serial. The trasmitted or received data packets consists of:
 	- A possible 4-bytes header (disabled with HostPort::NULL_HEADER).
+	- A possible 1-byte message ID (disabled by default, see HostPort::setIds()).
+	- Possible 8-bytes timestamps (disabled by default, see HostPort::setTimestamps()).
 	- The data bytes, for a maximum of BUF_SIZE bytes with MAX_OBJS objects.
+	- A possible 2-bytes or 4-bytes CRC of the message ID, timestamps and data bytes (disabled by default, see HostPort::setCrc()).
 	- A possible 4-bytes terminator (disabled with HostPort::NULL_TERMINATOR).
 
 	The HostPort object is created using
@@ -46,16 +51,59 @@
 	hostPort.write();
 	hostPort.read();
 	```
+
+	With the message IDs enabled, up to MAX_IDS different packets share the same serial. Each message ID has its own attached objects, 
+	or a callback called with the received data
+	
+	```c++
+	hostPort.setIds(true);
+	hostPort.attachTx(TELEMETRY_ID, (uint8_t*) &object1, sizeof(object1));
+	hostPort.attachRx(SETPOINT_ID, (uint8_t*) &object3, sizeof(object3));
+	hostPort.attachRx(PARAMS_ID, onParams, sizeof(params)); //void onParams(uint8_t id, const uint8_t* data, size_t size)
+	hostPort.write(TELEMETRY_ID);
+	if (hostPort.read()) { 
+		uint8_t id = hostPort.rxId(); //ID of the received message
+	}
+	```
+
+	The round-trip latency is measured enabling the timestamps on both sides, which echo the transmit time of the latest received packet
+
+	```c++
+	hostPort.setTimestamps(true);
+	if (hostPort.read()) { 
+		uint32_t rtt = hostPort.rxArrival() - hostPort.rxEcho(); //round-trip time (us)
+	}
+	const HostPort::Stats& stats = hostPort.stats(); //packets received, errors and parse time histogram
+	```
+
+	Signals sampled at lower rates than the loop can be batched in a single packet with HostTelemetry.
+
+	On the Teensy 4 hardware serials, the packets are received with DMA and parsed directly from the DMA ring using HostUart
+
+	```c++
+	HostUart uart(&Serial1);
+	uart.begin(3000000);
+	hostPort.setRing(&uart);
+	```
+
+	For packet layouts known at compile-time, HostPortT provides the same packet format without the MAX_OBJS and BUF_SIZE limits.
 	
+	\see HostPortT HostTelemetry HostUart
 	\author Stefano Lovato
 	\date 2022
 */
 
+/*! \brief Size of the HostPort buffers.
+	\details The size of the transmit and receive buffers of HostPort (256 bytes by default). Define it at build time to change it for all the HostPort objects.
+	\see HostPort::BUF_SIZE
+*/
+#ifndef HOSTPORT_BUF_SIZE
+#define HOSTPORT_BUF_SIZE 256
+#endif
+
 //using constexpr instead
-//#define BUF_SIZE 256 //size of buffers
 //#define MAX_OBJS 3 //max num of attached objects
 //#define MASK 0x000000FF //mask for bitwise operations
-//#define TIMEOUT_HOSTPORT 500 //timeout (us)
 
 class HostPort {
 public:
@@ -81,6 +129,27 @@ public:
 	*/
 	HostPort(Stream* serial); //constructor w/o header and terminator
 
+	//static constexpr
+	static constexpr uint8_t HIST_BINS = 16; //!< Histogram bins. \details The number of bins of the parse time histogram. \see Stats
+
+	/*! \brief Receive statistics.
+		\details The counters of the received packets and the parse time, i.e. the time from the arrival of the first byte to the complete packet. 
+		The parse time histogram has bins with log2 width: bin 0 counts 0 us, bin k counts from 2^(k-1) us to 2^k-1 us, and the last bin counts all the greater times.
+		\see stats resetStats
+	*/
+	struct Stats {
+		uint32_t ok; //!< Packets received.
+		uint32_t crcErrors; //!< Packets discarded for a wrong CRC.
+		uint32_t terminatorErrors; //!< Packets discarded for a wrong terminator.
+		uint32_t idErrors; //!< Packets discarded for an unknown message ID.
+		uint32_t timeouts; //!< Packets discarded for the timeout. \see setTimeout
+		uint32_t resyncs; //!< Resyncs performed. \see setResync
+		uint32_t overflows; //!< Packets discarded for an overflow of the receive ring. \see setRing HostRing::overflows
+		uint32_t parseMin; //!< Minimum parse time (us).
+		uint32_t parseMax; //!< Maximum parse time (us).
+		uint32_t parseHist[HIST_BINS]; //!< Parse time histogram.
+	};
+
 	//funs
 	/*! \brief Attach object for receiving.
 		\details The function attaches an object to the receive buffer. 
@@ -102,6 +171,46 @@ public:
 	*/
 	boolean attachTx(uint8_t* pointer, size_t size); //attach object for tx
 
+	/*! \brief Callback for received messages.
+		\details The function called by HostPort::read() when a message with the corresponding ID is received.
+		The arguments are the message ID, the pointer to the received data and the number of data bytes.
+		The data are valid during the call only.
+		\see attachRx(uint8_t, Callback, size_t)
+	*/
+	typedef void (*Callback)(uint8_t id, const uint8_t* data, size_t size);
+
+	/*! \brief Attach object for receiving with message ID.
+		\details The function attaches an object to the receive buffer of a message ID. 
+		A number of MAX_OBJS objects can be attached to each message ID, for a total of maximum BUF_SIZE bytes.
+		\param id The message ID, lower than MAX_IDS.
+		\param pointer The pointer to the object to attach. Cast to uint8_t is required.
+		\param size The size to the object to attach.
+		\return True if success, false if the message ID is not valid or dispatched to a callback, or if the buffer size or the number of objects exceeds BUF_SIZE or MAX_OBJS.
+		\see setIds MAX_IDS MAX_OBJS BUF_SIZE
+	*/
+	boolean attachRx(uint8_t id, uint8_t* pointer, size_t size); //attach object for rx with message ID
+
+	/*! \brief Attach object for tranmission with message ID.
+		\details The function attaches an object to the trasmit buffer of a message ID. 
+		A number of MAX_OBJS objects can be attached to each message ID, for a total of maximum BUF_SIZE bytes.
+		\param id The message ID, lower than MAX_IDS.
+		\param pointer The pointer to the object to attach. Cast to uint8_t is required.
+		\param size The size to the object to attach.
+		\return True if success, false if the message ID is not valid, or if the buffer size or the number of objects exceeds BUF_SIZE or MAX_OBJS.
+		\see setIds write(uint8_t) MAX_IDS MAX_OBJS BUF_SIZE
+	*/
+	boolean attachTx(uint8_t id, uint8_t* pointer, size_t size); //attach object for tx with message ID
+
+	/*! \brief Attach callback for receiving with message ID.
+		\details The function dispatches the messages with a message ID to a callback, instead of copying them into attached objects.
+		\param id The message ID, lower than MAX_IDS.
+		\param callback The callback. Use nullptr to remove the callback.
+		\param size The number of data bytes of the message, possibly 0.
+		\return True if success, false if the message ID is not valid or objects are attached to it, or if the size exceeds BUF_SIZE.
+		\see Callback setIds
+	*/
+	boolean attachRx(uint8_t id, Callback callback, size_t size); //dispatch rx message ID to callback
+
 	/*! \brief Write to serial.
 		\details The function writes the attached transmit objects to the serial.
 		\return True if success.
@@ -109,24 +218,215 @@ public:
 	*/
 	boolean write(); //write attached objects, return true if data written
 
+	/*! \brief Write to serial with message ID.
+		\details The function writes the transmit objects attached to a message ID to the serial. 
+		With the message IDs enabled, messages without attached objects (i.e. message ID only) can be written too.
+		\param id The message ID. Only 0 is valid when the message IDs are disabled.
+		\return True if success.
+		\attention The serial object must be started by the user before writing.
+		\see setIds
+	*/
+	boolean write(uint8_t id); //write attached objects of message ID, return true if data written
+
+	/*! \brief Enable or disable the gather-write.
+		\details With the gather-write enabled, HostPort::write() does not copy the attached transmit objects into the transmit buffer,
+		but writes the header, each attached object and the terminator directly to the serial, with one bulk write each.
+		This saves the copy of the whole packet, while the serial driver (e.g. the USB serial) still collects the bytes in its own packets.
+		The gather-write is disabled by default.
+		\param enable True to enable the gather-write, false to disable it.
+		\see write
+	*/
+	void setGatherWrite(boolean enable); //enable/disable the gather-write
+
 	/*! \brief Read from serial.
 		\details The function reads a data packet from the serial and saves it in the attached receive objects.
-		\return True if success.
+		The function never waits for data: it consumes only the bytes already available in the serial buffer 
+		and returns immediately. A partially received packet is kept and completed in the next calls.
+		The function returns after the first complete packet, thus more packets can be read with
+
+		```c++
+		while (hostPort.read()) { }
+		```
+
+		\return True if a complete packet was received, false otherwise (packet not complete yet, wrong CRC or wrong terminator).
 		\attention The serial object must be started by the user before reading.
 	*/
 	boolean read(); //read attached object, return true is data read
 
+	/*! \brief Set the CRC.
+		\details The function sets the CRC appended to the data bytes, before the terminator. 
+		The CRC is computed over all the bytes between the header and the CRC, i.e. the message ID (see HostPort::setIds()), the timestamps (see HostPort::setTimestamps()) and the data bytes, and it is sent least significant byte first. The header and the terminator are not covered. Packets with a wrong CRC are discarded by HostPort::read().
+		The supported CRCs are:
+		- HostPort::NO_CRC: no CRC (default).
+		- HostPort::CRC16: CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF).
+		- HostPort::CRC32: CRC-32 (as zlib, reflected polynomial 0xEDB88320, initial value and final xor 0xFFFFFFFF).
+
+		The CRC bytes reduce the maximum size of the attached objects.
+		\param type The CRC type, i.e. HostPort::NO_CRC, HostPort::CRC16 or HostPort::CRC32.
+		\return True if success, false if the CRC is not supported or the attached objects and the CRC exceed BUF_SIZE.
+		\see NO_CRC CRC16 CRC32 setResync
+	*/
+	boolean setCrc(uint8_t type); //set the CRC
+
+	/*! \brief Enable or disable the message IDs.
+		\details With the message IDs enabled, a 1-byte message ID is sent after the header, and the received messages are dispatched 
+		to the objects or the callback attached to their ID, with a table lookup. Messages with an unknown ID are discarded. 
+		When the message IDs are disabled (default), only the message ID 0 is used and no message ID is sent.
+		The message ID byte reduces the maximum size of the attached objects.
+		\param enable True to enable the message IDs, false to disable them.
+		\return True if success, false if the attached objects and the message ID exceed BUF_SIZE.
+		\see attachRx(uint8_t, uint8_t*, size_t) attachTx(uint8_t, uint8_t*, size_t) rxId MAX_IDS
+	*/
+	boolean setIds(boolean enable); //enable/disable the message IDs
+
+	/*! \brief Message ID of the latest received message.
+		\details The message ID of the latest message copied in the attached receive objects or passed to a callback.
+		\return The message ID (0 when the message IDs are disabled).
+		\see setIds
+	*/
+	uint8_t rxId() const; //ID of the latest received message
+
+	/*! \brief Enable or disable the timestamps.
+		\details With the timestamps enabled, 8 bytes are sent after the message ID: the micros() when the packet is written, 
+		and the echo of the transmit time of the latest packet received from the other side. Both are covered by the CRC.
+		When both sides enable the timestamps, the round-trip time is rxArrival() - rxEcho(), measured with the local clock only.
+		The timestamps reduce the maximum size of the attached objects. The timestamps are disabled by default.
+		\param enable True to enable the timestamps, false to disable them.
+		\return True if success, false if the attached objects and the timestamps exceed BUF_SIZE.
+		\see rxArrival rxTimestamp rxEcho
+	*/
+	boolean setTimestamps(boolean enable); //enable/disable the timestamps
+
+	/*! \brief Arrival time of the latest packet.
+		\details The micros() when the first byte of the latest received packet was parsed, available also without the timestamps.
+		\return The arrival time (us).
+	*/
+	uint32_t rxArrival() const { return _rx_arrival; } //arrival time of the latest packet
+
+	/*! \brief Transmit time of the latest packet.
+		\details The transmit time of the latest received packet, with the clock of the other side.
+		\return The transmit time (us), 0 if the timestamps are disabled.
+		\see setTimestamps
+	*/
+	uint32_t rxTimestamp() const { return _rx_peer; } //peer transmit time of the latest packet
+
+	/*! \brief Echo of the latest packet.
+		\details The local transmit time echoed by the other side in the latest received packet, i.e. the transmit time of the latest packet it received.
+		\return The echoed transmit time (us), 0 if the timestamps are disabled.
+		\see setTimestamps
+	*/
+	uint32_t rxEcho() const { return _rx_echo; } //local transmit time echoed in the latest packet
+
+	/*! \brief Set the receive timeout.
+		\details A packet partially received is discarded when its first byte arrived more than timeout us before the call to HostPort::read().
+		The timeout is disabled by default.
+		\param timeout The timeout (us), 0 to disable it.
+	*/
+	void setTimeout(uint32_t timeout); //set the timeout of partial packets
+
+	/*! \brief Receive statistics.
+		\return The receive statistics since the creation or the latest HostPort::resetStats().
+		\see Stats resetStats
+	*/
+	const Stats& stats() const { return _stats; } //receive statistics
+
+	/*! \brief Reset the receive statistics.
+		\see stats
+	*/
+	void resetStats(void); //reset the receive statistics
+
+	/*! \brief Enable or disable the resync.
+		\details Without resync, a packet with a wrong CRC or terminator is discarded together with its bytes.
+		With the resync enabled, HostPort::read() parses again the bytes of the discarded packet after its first byte, 
+		so that a valid header inside them is found and the following packet is not lost. The resync is disabled by default.
+		The bytes to parse again are saved in a replay buffer provided by the user, thus the resync costs no memory when disabled.
+		\param buffer The replay buffer, with size BUF_SIZE at least, or nullptr to disable the resync.
+		\attention Any packet partially replayed is discarded.
+		\see setCrc BUF_SIZE
+	*/
+	void setResync(uint8_t* buffer); //enable/disable the resync
+
+	/*! \brief Set the receive ring.
+		\details With a receive ring, HostPort::read() parses the bytes directly from the ring, with no virtual call per byte, 
+		instead of reading them from the serial. The serial is still used for transmitting.
+		\param ring The pointer to the ring, nullptr to read from the serial (default).
+		\attention Any packet partially received is discarded.
+		\see HostRing HostUart
+	*/
+	void setRing(HostRing* ring); //set the receive ring
+
+	/*! \brief Enable or disable the double-buffered receive.
+		\details With the double-buffered receive enabled, HostPort::read() does not copy the received packets into the attached receive objects.
+		Packets are instead received in a back buffer, which is swapped with the front buffer by a single pointer write when the packet is complete.
+		The attached receive objects are then updated with HostPort::snapshot(), which always gives a consistent packet,
+		even when HostPort::read() is called from an interrupt. Messages dispatched to a callback are not double-buffered. 
+		The double-buffered receive is disabled by default. The second receive buffer is provided by the user, 
+		thus the double-buffered receive costs no memory when disabled.
+		\param buffer The second receive buffer, with size BUF_SIZE at least, or nullptr to disable the double-buffered receive.
+		\attention Any packet partially received is discarded.
+		\see snapshot sequence BUF_SIZE
+	*/
+	void setDoubleBuffer(uint8_t* buffer); //enable/disable the double-buffered receive
+
+	/*! \brief Copy the latest packet in the receive objects.
+		\details The function copies the latest packet received with the double-buffered receive into the attached receive objects.
+		The copy is repeated if a new packet is completed in the meantime, so that the receive objects never contain parts of different packets.
+		\return The sequence number of the copied packet.
+		\see setDoubleBuffer sequence
+	*/
+	uint32_t snapshot(); //copy the latest packet in the rx objects, return its sequence number
+
+	/*! \brief Sequence number.
+		\details The number of packets successfully received, which changes each time a new packet is available.
+		\return The sequence number of the latest packet.
+		\see snapshot
+	*/
+	uint32_t sequence() const { return _rx_seq; } //num of received packets
+
+	/*! \brief Put 4 bytes in a buffer.
+		\details The function puts the 4 bytes of a value in a buffer, least significant byte first. It is shared with HostPortT.
+		\param buf The buffer, with size 4 at least.
+		\param val The value.
+	*/
+	static inline void put32(uint8_t* buf, uint32_t val) { //put val in buf, LSB first
+		buf[0] = val & MASK;
+		buf[1] = (val >> 8) & MASK;
+		buf[2] = (val >> 16) & MASK;
+		buf[3] = (val >> 24) & MASK;
+	}
+
+	/*! \brief Match a header byte.
+		\details The function returns the number of header bytes matched after a received byte. On a mismatch, the matched bytes
+		are rescanned for the longest suffix that is also the beginning of the header (as in the Knuth-Morris-Pratt algorithm),
+		thus self-overlapping headers (e.g. 0xAA 0xAA 0xBB 0xCC) resync at the first byte of the new header. It is shared with HostPortT.
+		\param header The 4-bytes header, sent LSB first.
+		\param state The number of header bytes already matched (0-3).
+		\param b The received byte.
+		\return The number of header bytes matched (0-4).
+	*/
+	static inline uint8_t hdrmatch(uint32_t header, uint8_t state, uint8_t b) { //header bytes matched after b
+		for (uint8_t k = state + 1; k > 0; k--) { //k header bytes matched if the last k-1 matched bytes and b begin the header
+			uint8_t i = 0;
+			while ((i < k - 1) && (((header >> (8 * i)) & MASK) == ((header >> (8 * (state - k + 1 + i))) & MASK))) i++;
+			if ((i == k - 1) && (b == ((header >> (8 * i)) & MASK))) return k;
+		}
+		return 0;
+	}
+
 	//static constexpr
 	static constexpr uint32_t NULL_HEADER = 0x00000000; //!< Null header. \details The value used for no header.
 	static constexpr uint32_t NULL_TERMINATOR = 0x00000000; //!< Null terminator. \details The value used for no terminator.
+	static constexpr size_t BUF_SIZE = HOSTPORT_BUF_SIZE; //!< Buffer size. \details The size of the transmit and receive buffers, i.e. the maximum packet size. It is 256 bytes, unless HOSTPORT_BUF_SIZE is defined at build time (e.g. `-DHOSTPORT_BUF_SIZE=512` for the packet size of the Teensy 4.1 high-speed USB). \see HOSTPORT_BUF_SIZE
+	static constexpr size_t MAX_OBJS = 4; //!< Maximum objects. \details The number of maximum attached objects to the transmit and receive buffers-
+	static constexpr uint8_t MAX_IDS = 8; //!< Maximum message IDs. \details The number of message IDs, from 0 to MAX_IDS-1. \see setIds
+	static constexpr uint8_t NO_CRC = 0; //!< No CRC. \details The value used for no CRC. \see setCrc
+	static constexpr uint8_t CRC16 = 2; //!< CRC-16. \details The value used for the 2-bytes CRC-16/CCITT-FALSE. \see setCrc
+	static constexpr uint8_t CRC32 = 4; //!< CRC-32. \details The value used for the 4-bytes CRC-32. \see setCrc
 
 private:
 
 	//static constexpr
-	static constexpr size_t BUF_SIZE = 256; //!< Buffer size. \details The size of the transmit and receive buffers.
-	static constexpr size_t MAX_OBJS = 4; //!< Maximum objects. \details The number of maximum attached objects to the transmit and receive buffers-
 	static constexpr uint32_t MASK = 0x000000FF; //!< A mask for parsing stuff.
-	static constexpr uint32_t TIMEOUT_HOSTPORT = 500; //!< Timeout for the reading (us).
 
 	//funs
 	/*! \brief Initialize the host port.
@@ -135,23 +435,145 @@ private:
 	void init(void); //general init in costructors
 
 	/*! \brief Copy receive buffer into receive objects
-		\details The function copies the receive buffer into the receive attached objects when the read is successful.
+		\details The function copies a receive buffer into the receive attached objects of its message ID when the read is successful.
+		\param buf The receive buffer to copy.
+	*/
+	void copyrx(const uint8_t* buf); //copy buf in _ptr_rx when reading was ok
+
+	/*! \brief Complete the receive of a packet.
+		\details The function copies the back buffer into the receive objects, or flips the front and back buffers with the double-buffered receive.
+		\see setDoubleBuffer
+	*/
+	void rxdone(void); //packet received, copy or flip buffers
+
+	/*! \brief Write to serial without copy.
+		\details The function writes the header, the attached transmit objects and the terminator directly to the serial, without using the transmit buffer.
+		\param id The message ID.
+		\return True if success.
+		\see setGatherWrite
+	*/
+	boolean writegather(uint8_t id); //write attached objects w/o copy in _tx_buf
+
+	/*! \brief Check if a message ID is received.
+		\param id The message ID.
+		\return True if objects or a callback are attached to the message ID.
+	*/
+	boolean rxattached(uint8_t id) const; //objects or callback attached to rx message ID
+
+	/*! \brief Size of the packet prefix.
+		\return The number of bytes of message ID and timestamps before the data.
+	*/
+	size_t prefix(void) const; //bytes of message ID and timestamps
+
+	/*! \brief Maximum data size.
+		\param crc The CRC type.
+		\param prefix The bytes of message ID and timestamps.
+		\return The maximum size of the objects attached to a message ID.
+	*/
+	size_t maxdata(uint8_t crc, size_t prefix) const; //max bytes of attached objects
+
+	/*! \brief Check the size of the attached objects.
+		\param crc The CRC type.
+		\param prefix The bytes of message ID and timestamps.
+		\return True if the attached objects of all message IDs fit in the buffers.
+	*/
+	boolean fits(uint8_t crc, size_t prefix) const; //attached objects fit in the buffers
+
+	/*! \brief Discard the packet being received.
+		\details The function discards the packet being received after a wrong CRC or terminator and prepares the resync, if enabled.
+		\return True if parsing continues with the resync.
+		\see setResync
+	*/
+	boolean rxfail(void); //discard the packet, return true if resync
+
+	/*! \brief Prepare the replay of a discarded packet.
+		\details The function saves the bytes of the discarded packet after its first byte in the replay buffer, 
+		before the bytes not replayed yet, so that they are parsed again by HostPort::read().
+		\see setResync
+	*/
+	void replay(void); //save the discarded packet bytes for the resync
+
+	/*! \brief Number of bytes to parse.
+		\return The number of bytes in the replay buffer, or the number of bytes available in the serial if there is nothing to replay.
+	*/
+	int rxavailable(void); //num of bytes to parse
+
+	/*! \brief Get a byte to parse.
+		\return The next byte of the replay buffer, or of the serial if there is nothing to replay.
+	*/
+	uint8_t rxbyte(void); //get the next byte to parse
+
+	/*! \brief Get bytes to parse.
+		\param buf The buffer where bytes are saved.
+		\param len The number of bytes, not greater than rxavailable().
+		\return The number of bytes saved.
+	*/
+	size_t rxbytes(uint8_t* buf, size_t len); //get the next len bytes to parse
+
+	/*! \brief Initial value of the CRC.
+		\return The initial value of the CRC set with HostPort::setCrc().
+	*/
+	uint32_t crcinit(void) const; //initial value of the CRC
+
+	/*! \brief Update the CRC.
+		\details The function updates the CRC with a table lookup per byte.
+		\param crc The current CRC.
+		\param buf The bytes.
+		\param len The number of bytes.
+		\return The updated CRC.
+	*/
+	uint32_t crcupdate(uint32_t crc, const uint8_t* buf, size_t len) const; //update the CRC with len bytes
+
+	/*! \brief Final value of the CRC.
+		\param crc The current CRC.
+		\return The final CRC, to be sent or compared.
+	*/
+	uint32_t crcfinal(uint32_t crc) const; //final value of the CRC
+
+	/*! \brief Reset the receive parser.
+		\details The function resets the state of the receive parser, so that the next byte is parsed as the beginning of a new packet.
 	*/
-	void copyrx(void); //copy _rx_buf in _ptr_rx when reading was ok
+	void resetrx(void); //reset the rx parser state
 
 	//vars
 	uint8_t _rx_buf[BUF_SIZE] = { 0 }; //!< Receive buffer. \details The receive buffer has size BUF_SIZE. \see BUF_SIZE attachRx
+	uint8_t* _rx_buf2 = nullptr; //!< Second receive buffer. \details The second receive buffer provided by the user, used by the double-buffered receive. \see setDoubleBuffer
+	uint8_t* _rx_back = _rx_buf; //!< Back receive buffer. \details The receive buffer where the incoming packet is saved. \see setDoubleBuffer
+	uint8_t* volatile _rx_front = _rx_buf2; //!< Front receive buffer. \details The receive buffer with the latest complete packet, used by the double-buffered receive. \see setDoubleBuffer snapshot
+	volatile uint32_t _rx_seq = 0; //!< Sequence number. \details The number of packets successfully received. \see sequence
+	volatile boolean _rx_ready = false; //!< Front buffer flag. \details True if the front buffer contains a packet. It is set by read(), possibly in an interrupt, and checked by snapshot(), thus it is volatile as _rx_seq. \see setDoubleBuffer
+	boolean _dbuf = false; //!< Double-buffered receive flag. \details True if the double-buffered receive is enabled. \see setDoubleBuffer
 	uint8_t _tx_buf[BUF_SIZE] = { 0 }; //!< Transmit buffer. \details The transmit buffer has size BUF_SIZE. \see BUF_SIZE attachTx
 	uint32_t _header = NULL_HEADER; //!< 4-bytes header. \details The 4-bytes header is null when equal to NULL_HEADER. \see NULL_HEADER
 	uint32_t _terminator = NULL_TERMINATOR; //!< 4-bytes terminator. \details The 4-bytes terminator is null when equal to NULL_TERMINATOR. \see NULL_TERMINATOR
-	uint8_t* _ptr_rx[MAX_OBJS] = { nullptr }; //!< Pointers to receive objects. \details The arrays of pointers to the receive attached objects. It has size MAX_OBJS. \see MAX_OBJS attachRx
-	uint8_t* _ptr_tx[MAX_OBJS] = { nullptr }; //!< Pointers to transmit objects. \details The arrays of pointers to the transmit attached objects. It has size MAX_OBJS. \see MAX_OBJS attachTx
-	size_t _size_rx[MAX_OBJS] = { 0 }; //!< Sizes of receive objects. \details The arrays of sizes of the receive attached objects. It has size MAX_OBJS. \see MAX_OBJS attachRx
-	size_t _size_tx[MAX_OBJS] = { 0 }; //!< Sizes of transmit objects. \details The arrays of sizes of the transmit attached objects. It has size MAX_OBJS. \see MAX_OBJS attachTx
-	size_t _totSize_rx = 0; //!< Total size of receive objects. \details The total size of receive objects must be lower than BUF_SIZE. \see BUF_SIZE
-	size_t _totSize_tx = 0; //!< Total size of transmit objects. \details The total size of transmit objects must be lower than BUF_SIZE. \see BUF_SIZE
-	uint8_t _numObj_rx = 0; //!< Total number of receive objects. \details The total number of receive objects must be lower than MAX_OBJS. \see MAX_OBJS
-	uint8_t _numObj_tx = 0; //!< Total number of transmit objects. \details The total number of transmit objects must be lower than MAX_OBJS. \see MAX_OBJS
+	uint8_t* _ptr_rx[MAX_IDS][MAX_OBJS] = { { nullptr } }; //!< Pointers to receive objects. \details The arrays of pointers to the receive attached objects for each message ID. It has size MAX_IDSxMAX_OBJS. \see MAX_OBJS attachRx
+	uint8_t* _ptr_tx[MAX_IDS][MAX_OBJS] = { { nullptr } }; //!< Pointers to transmit objects. \details The arrays of pointers to the transmit attached objects for each message ID. It has size MAX_IDSxMAX_OBJS. \see MAX_OBJS attachTx
+	size_t _size_rx[MAX_IDS][MAX_OBJS] = { { 0 } }; //!< Sizes of receive objects. \details The arrays of sizes of the receive attached objects for each message ID. It has size MAX_IDSxMAX_OBJS. \see MAX_OBJS attachRx
+	size_t _size_tx[MAX_IDS][MAX_OBJS] = { { 0 } }; //!< Sizes of transmit objects. \details The arrays of sizes of the transmit attached objects for each message ID. It has size MAX_IDSxMAX_OBJS. \see MAX_OBJS attachTx
+	size_t _totSize_rx[MAX_IDS] = { 0 }; //!< Total size of receive objects. \details The total size of receive objects for each message ID must be lower than BUF_SIZE. \see BUF_SIZE
+	size_t _totSize_tx[MAX_IDS] = { 0 }; //!< Total size of transmit objects. \details The total size of transmit objects for each message ID must be lower than BUF_SIZE. \see BUF_SIZE
+	uint8_t _numObj_rx[MAX_IDS] = { 0 }; //!< Total number of receive objects. \details The total number of receive objects for each message ID must be lower than MAX_OBJS. \see MAX_OBJS
+	uint8_t _numObj_tx[MAX_IDS] = { 0 }; //!< Total number of transmit objects. \details The total number of transmit objects for each message ID must be lower than MAX_OBJS. \see MAX_OBJS
+	Callback _callback_rx[MAX_IDS] = { nullptr }; //!< Receive callbacks. \details The dispatch table of the callbacks for each message ID. \see attachRx(uint8_t, Callback, size_t)
+	boolean _ids = false; //!< Message IDs flag. \details True if the message IDs are enabled. \see setIds
+	uint8_t _rx_id = 0; //!< Message ID of the latest received message. \see rxId
+	boolean _gather = false; //!< Gather-write flag. \details True if the gather-write is enabled. \see setGatherWrite
+	uint8_t _crc = NO_CRC; //!< CRC type. \details The number of CRC bytes, i.e. NO_CRC, CRC16 or CRC32. \see setCrc
+	uint8_t* _rp_buf = nullptr; //!< Replay buffer. \details The replay buffer provided by the user, with the bytes of discarded packets parsed again with the resync. The resync is disabled when null. \see setResync
+	size_t _rp_len = 0; //!< Number of bytes in the replay buffer.
+	size_t _rp_pos = 0; //!< Number of bytes already replayed.
+	boolean _ts = false; //!< Timestamps flag. \details True if the timestamps are enabled. \see setTimestamps
+	uint32_t _rx_t0 = 0; //!< Arrival time of the first byte of the packet being received.
+	uint32_t _rx_arrival = 0; //!< Arrival time of the latest packet. \see rxArrival
+	uint32_t _rx_peer = 0; //!< Peer transmit time of the latest packet. \see rxTimestamp
+	uint32_t _rx_echo = 0; //!< Echoed transmit time of the latest packet. \see rxEcho
+	uint32_t _timeout = 0; //!< Receive timeout (us). \details No timeout when 0. \see setTimeout
+	Stats _stats = { }; //!< Receive statistics. \see stats
+	uint8_t _rx_trail[8] = { 0 }; //!< Received CRC and stop bytes.
+	uint8_t _rx_tidx = 0; //!< Number of CRC and stop bytes received.
+	uint8_t _rx_state = 0; //!< State of the receive parser. \details Values 0-3 for the header bytes, 4 for the data bytes and 5 for the CRC and terminator bytes. \see read
+	size_t _rx_idx = 0; //!< Number of data bytes received. \details The number of data bytes of the current packet already saved in the receive buffer. \see read
+	HostRing* _ring = nullptr; //!< Pointer to the receive ring. \details Bytes are read from the serial when null. \see setRing
 	Stream* _serial = nullptr; //!< Pointer to Stream object. \details The pointer to a Stream object representing the serial. \attention The serial must be started before using this class.
 };
 
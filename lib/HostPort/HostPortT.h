@@ -0,0 +1,236 @@
+#ifndef _HOSTPORTT_H
+#define _HOSTPORTT_H
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <type_traits>
+
+#include "HostPort.h"
+
+/*! \brief Helpers for the compile-time packet layout of HostPortT.
+	\details Templates used by HostPortT to compute sizes and offsets and to pack/unpack the objects at compile-time.
+	\see HostPortT
+*/
+namespace hostport_detail {
+
+	/*! \brief Sum of the sizes of a list of types.
+		\details The value is the sum of sizeof(T) for all the types in the list.
+	*/
+	template <typename... Ts>
+	struct SizeSum {
+		static constexpr size_t value = 0; //!< Sum of the sizes.
+	};
+
+	template <typename T, typename... Ts>
+	struct SizeSum<T, Ts...> {
+		static constexpr size_t value = sizeof(T) + SizeSum<Ts...>::value; //!< Sum of the sizes.
+	};
+
+	/*! \brief Offset of an object in the packet data.
+		\details The value is the sum of sizeof(T) for the first I types in the list.
+	*/
+	template <size_t I, typename... Ts>
+	struct Offset {
+		static constexpr size_t value = 0; //!< Offset (bytes).
+	};
+
+	template <size_t I, typename T, typename... Ts>
+	struct Offset<I, T, Ts...> {
+		static constexpr size_t value = (I == 0) ? 0 : sizeof(T) + Offset<I - 1, Ts...>::value; //!< Offset (bytes).
+	};
+
+	//pack objects in buf, one memcpy with constant size per object
+	inline void pack(uint8_t*) { }
+
+	template <typename T, typename... Ts>
+	inline void pack(uint8_t* buf, const T& obj, const Ts&... objs) {
+		static_assert(std::is_trivially_copyable<T>::value, "HostPortT objects must be trivially copyable");
+		memcpy(buf, &obj, sizeof(T));
+		pack(buf + sizeof(T), objs...);
+	}
+
+	//unpack objects from buf, one memcpy with constant size per object
+	inline void unpack(const uint8_t*) { }
+
+	template <typename T, typename... Ts>
+	inline void unpack(const uint8_t* buf, T& obj, Ts&... objs) {
+		static_assert(std::is_trivially_copyable<T>::value, "HostPortT objects must be trivially copyable");
+		memcpy(&obj, buf, sizeof(T));
+		unpack(buf + sizeof(T), objs...);
+	}
+
+}
+
+/*! \brief The types of the data objects of HostPortT.
+	\details The list of the types of the data objects of one direction of HostPortT, in packet order.
+	Use HostPortObjs<> for a direction which is not used.
+	\tparam Ts The types of the data objects.
+	\see HostPortT
+*/
+template <typename... Ts>
+struct HostPortObjs { };
+
+/*! \brief A class for communication with PC via USB/serial with compile-time packet layout.
+	\details The class is the compile-time version of HostPort. The packet consists of the same
+	4-bytes header, data bytes and 4-bytes terminator, thus it is compatible with HostPort without CRC, message IDs and timestamps, but
+	the header, the terminator and the types of the data objects are template parameters. Sizes
+	and offsets are computed at compile-time, the buffers have exactly the size of the packet and
+	there is no limit on the number of objects. Transmit and receive packets have their own list of types,
+	and a direction without objects has no buffer.
+
+	The HostPortT object is created using
+
+	```c++
+	HostPortT<header, terminator, HostPortObjs<float, int32_t>> hostPort(&Serial); //same objects in both directions
+	HostPortT<header, terminator, HostPortObjs<float, int32_t>, HostPortObjs<uint8_t>> hostPort(&Serial); //float and int32_t transmitted, uint8_t received
+	HostPortT<HostPort::NULL_HEADER, HostPort::NULL_TERMINATOR, HostPortObjs<float>, HostPortObjs<>> hostPort(&Serial); //transmit only, with neither header nor terminator
+	```
+
+	Trasfering and receiving is performed using
+
+	```c++
+	hostPort.write(object1, object2);
+	hostPort.read(object3);
+	```
+
+	\tparam Header The 4-bytes header of the data packet. Use HostPort::NULL_HEADER for no header.
+	\tparam Terminator The 4-bytes terminator of the data packet. Use HostPort::NULL_TERMINATOR for no terminator.
+	\tparam TxObjs The types of the transmitted data objects, as HostPortObjs.
+	\tparam RxObjs The types of the received data objects, as HostPortObjs (default TxObjs).
+	\attention CRC, message IDs, timestamps and resync are not supported, use HostPort for them.
+	\see HostPort HostPortObjs
+	\author Stefano Lovato
+	\date 2022
+*/
+template <uint32_t Header, uint32_t Terminator, typename TxObjs, typename RxObjs = TxObjs>
+class HostPortT;
+
+template <uint32_t Header, uint32_t Terminator, typename... TxTs, typename... RxTs>
+class HostPortT<Header, Terminator, HostPortObjs<TxTs...>, HostPortObjs<RxTs...>> {
+	static_assert((sizeof...(TxTs) > 0) || (sizeof...(RxTs) > 0), "at least one data object is required");
+
+public:
+	//static constexpr
+	static constexpr size_t HEADER_SIZE = (Header != 0) ? 4 : 0; //!< Header size (bytes).
+	static constexpr size_t TERMINATOR_SIZE = (Terminator != 0) ? 4 : 0; //!< Terminator size (bytes).
+	static constexpr size_t TX_DATA_SIZE = hostport_detail::SizeSum<TxTs...>::value; //!< Transmit data size (bytes). \details The sum of the sizes of the transmitted data objects.
+	static constexpr size_t RX_DATA_SIZE = hostport_detail::SizeSum<RxTs...>::value; //!< Receive data size (bytes). \details The sum of the sizes of the received data objects.
+	static constexpr size_t TX_PACKET_SIZE = HEADER_SIZE + TX_DATA_SIZE + TERMINATOR_SIZE; //!< Transmit packet size (bytes).
+	static constexpr size_t RX_PACKET_SIZE = HEADER_SIZE + RX_DATA_SIZE + TERMINATOR_SIZE; //!< Receive packet size (bytes).
+	static constexpr size_t NUM_TX_OBJS = sizeof...(TxTs); //!< Number of transmitted data objects.
+	static constexpr size_t NUM_RX_OBJS = sizeof...(RxTs); //!< Number of received data objects.
+
+	/*! \brief Offset of a transmitted data object.
+		\details The offset of the I-th transmitted data object in the data bytes of the packet, computed at compile-time.
+		\tparam I The index of the data object.
+		\return The offset (bytes).
+	*/
+	template <size_t I>
+	static constexpr size_t txOffset() {
+		static_assert(I < sizeof...(TxTs), "index out of range");
+		return hostport_detail::Offset<I, TxTs...>::value;
+	}
+
+	/*! \brief Offset of a received data object.
+		\details The offset of the I-th received data object in the data bytes of the packet, computed at compile-time.
+		\tparam I The index of the data object.
+		\return The offset (bytes).
+	*/
+	template <size_t I>
+	static constexpr size_t rxOffset() {
+		static_assert(I < sizeof...(RxTs), "index out of range");
+		return hostport_detail::Offset<I, RxTs...>::value;
+	}
+
+	/*! \brief Contructor.
+		\param serial The pointer to the Stream object used for the serial.
+	*/
+	explicit HostPortT(Stream* serial) : _serial(serial) { }
+
+	/*! \brief Write to serial.
+		\details The function packs the objects and writes the packet to the serial with one bulk write.
+		\param objs The transmitted data objects.
+		\return True if success.
+		\attention The serial object must be started by the user before writing.
+	*/
+	boolean write(const TxTs&... objs) {
+		static_assert(sizeof...(TxTs) > 0, "no transmitted data objects");
+		if (!(_serial)) { //serial not available
+			return false;
+		}
+		if (HEADER_SIZE) HostPort::put32(_tx_buf, Header);
+		hostport_detail::pack(_tx_buf + HEADER_SIZE, objs...);
+		if (TERMINATOR_SIZE) HostPort::put32(_tx_buf + HEADER_SIZE + TX_DATA_SIZE, Terminator);
+		_serial->write(_tx_buf, TX_PACKET_SIZE);
+		return true; //all is ok
+	}
+
+	/*! \brief Read from serial.
+		\details The function reads a data packet from the serial and saves it in the objects.
+		As HostPort::read(), the function consumes only the bytes already available and returns immediately,
+		keeping a partially received packet for the next calls. The objects are modified only when a complete packet is received.
+		\param objs The received data objects.
+		\return True if a complete packet was received.
+		\attention The serial object must be started by the user before reading.
+	*/
+	boolean read(RxTs&... objs) {
+		static_assert(sizeof...(RxTs) > 0, "no received data objects");
+		if (!(_serial)) { //serial not available
+			return false;
+		}
+
+		int avail; //num of bytes available in the serial buffer
+		while ((avail = _serial->available()) > 0) {
+			if (_state < 4) { //looking for the header
+				if (!HEADER_SIZE) { //no header, go directly to the data
+					_state = 4;
+					continue;
+				}
+				_state = HostPort::hdrmatch(Header, _state, _serial->read()); //compare to header, restart from the longest partial header on a mismatch
+			}
+			else if (_state == 4) { //read actual data
+				size_t n = RX_DATA_SIZE - _idx; //bytes still missing
+				if ((size_t) avail < n) n = avail; //read only what is available
+				_idx += _serial->readBytes(_rx_buf + _idx, n);
+				if (_idx < RX_DATA_SIZE) { //data not complete yet
+					continue;
+				}
+				if (!TERMINATOR_SIZE) { //no terminator, all is ok
+					_state = 0;
+					_idx = 0;
+					hostport_detail::unpack(_rx_buf, objs...);
+					return true;
+				}
+				_state++; //data read, go to terminator
+			}
+			else { //check stop bytes
+				uint8_t b = _serial->read();
+				if (b != ((Terminator >> (8 * (_state - 5))) & 0xFF)) { //wrong terminator, discard packet
+					_state = 0;
+					_idx = 0;
+					return false;
+				}
+				if (++_state == 9) { //all stop bytes read ok
+					_state = 0;
+					_idx = 0;
+					hostport_detail::unpack(_rx_buf, objs...);
+					return true;
+				}
+			}
+		}
+		return false; //packet not complete yet
+	}
+
+private:
+	uint8_t _tx_buf[NUM_TX_OBJS ? TX_PACKET_SIZE : 1] = { 0 }; //!< Transmit buffer. \details The transmit buffer has the size of the transmit packet (a single byte if nothing is transmitted).
+	uint8_t _rx_buf[NUM_RX_OBJS ? RX_DATA_SIZE : 1] = { 0 }; //!< Receive buffer. \details The receive buffer has the size of the received data bytes (a single byte if nothing is received).
+	uint8_t _state = 0; //!< State of the receive parser. \details Values 0-3 for the header bytes, 4 for the data bytes and 5-8 for the terminator bytes.
+	size_t _idx = 0; //!< Number of data bytes received.
+	Stream* _serial = nullptr; //!< Pointer to Stream object. \attention The serial must be started before using this class.
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef _HOSTRING_H
+#define _HOSTRING_H
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+/*! \brief A receive ring buffer for HostPort.
+	\details The class is a circular buffer filled by a producer outside the CPU loop (e.g. a DMA channel or an interrupt),
+	from which HostPort::read() parses the packets directly, without a virtual call per byte as with Stream::read().
+	The producer position is read once per call to HostPort::read() with the only virtual function head(),
+	then bytes are taken with inline non-virtual functions, using at most two memcpy for a block of bytes.
+
+	A ring is used by HostPort with
+
+	```c++
+	hostPort.setRing(&ring); //packets are read from the ring, written to the serial
+	```
+
+	The ring size must be a power of 2 and the producer must not write more than size-1 bytes ahead of the consumer,
+	i.e. HostPort::read() must be called often enough for the baudrate. A producer which can detect that it lapped the consumer
+	discards the bytes overwritten and counts an overflow (see HostRing::overflows()).
+	\see HostPort::setRing HostUart
+	\author Stefano Lovato
+	\date 2022
+*/
+class HostRing {
+public:
+	/*! \brief Contructor.
+		\param buf The ring buffer.
+		\param size The size of the ring buffer, power of 2.
+	*/
+	HostRing(volatile uint8_t* buf, size_t size) : _buf(buf), _mask(size - 1) { }
+
+	/*! \brief Producer position.
+		\details The function returns the index of the next byte written by the producer.
+		\return The index, between 0 and size-1.
+	*/
+	virtual size_t head(void) = 0; //index of the next byte written by the producer
+
+	/*! \brief Update the producer position.
+		\details The function reads the producer position, so that the bytes received so far are available.
+	*/
+	void update(void) { _head = head(); } //read the producer position
+
+	/*! \brief Number of available bytes.
+		\return The number of bytes received up to the latest update() and not taken yet.
+	*/
+	size_t available(void) const { return (_head - _tail) & _mask; } //num of bytes available
+
+	/*! \brief Take a byte.
+		\return The next byte.
+		\attention Call only if available() is not 0.
+	*/
+	uint8_t get(void) { //take a byte
+		uint8_t b = _buf[_tail];
+		_tail = (_tail + 1) & _mask;
+		return b;
+	}
+
+	/*! \brief Take bytes.
+		\param buf The buffer where bytes are saved.
+		\param len The number of bytes, not greater than available().
+		\return The number of bytes saved.
+	*/
+	size_t get(uint8_t* buf, size_t len) { //take len bytes
+		size_t n = _mask + 1 - _tail; //bytes before the end of the ring
+		if (n > len) n = len;
+		memcpy(buf, (const uint8_t*) _buf + _tail, n);
+		memcpy(buf + n, (const uint8_t*) _buf, len - n); //wrapped bytes
+		_tail = (_tail + len) & _mask;
+		return len;
+	}
+
+	/*! \brief Discard the available bytes.
+		\details The function discards the bytes received so far, e.g. after the ring was not read for a long time.
+	*/
+	void clear(void) { update(); _tail = _head; } //discard the available bytes
+
+	/*! \brief Number of overflows.
+		\details The number of times the producer wrote over bytes not taken yet, which were then discarded.
+		\return The number of overflows.
+	*/
+	uint32_t overflows(void) const { return _overflows; } //num of overflows
+
+protected:
+	volatile uint8_t* _buf = nullptr; //!< Ring buffer.
+	size_t _mask = 0; //!< Mask of the indices. \details The size of the ring buffer minus 1.
+	size_t _head = 0; //!< Producer position. \details The index of the next byte written by the producer, at the latest update().
+	size_t _tail = 0; //!< Consumer position. \details The index of the next byte taken.
+	uint32_t _overflows = 0; //!< Number of overflows. \details Incremented by the producer in head(). \see overflows
+};
+
+#endif
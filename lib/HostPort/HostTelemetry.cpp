@@ -0,0 +1,73 @@
+#include "HostTelemetry.h"
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+//Constructor
+HostTelemetry::HostTelemetry(HostPort* port, uint8_t id) {
+	_port = port;
+	_id = id;
+}
+
+//Attach function
+boolean HostTelemetry::attach(uint8_t* pointer, size_t size, uint16_t decimation) {
+	if (_ticks != 0) { //already started
+		return false;
+	}
+	if (_numCh >= MAX_CHANNELS) { //max MAX_CHANNELS signals can be attached
+		return false;
+	}
+	if (decimation == 0) { //decimation not valid
+		return false;
+	}
+	_ptr[_numCh] = pointer; //assign pointer
+	_sizes[_numCh] = size; //assign size
+	_dec[_numCh] = decimation; //assign decimation
+	_numCh++; //increase num of attached signals
+	return true;
+}
+
+//Start the telemetry
+boolean HostTelemetry::begin(uint16_t ticks) {
+	if (!(_port) || (_ticks != 0) || (_numCh == 0) || (ticks == 0)) { //nothing to do or already started
+		return false;
+	}
+	size_t k = 0; //offset counter
+	for (uint8_t j = 0; j < _numCh; j++) {
+		if ((ticks % _dec[j]) != 0) { //ticks must be multiple of decimation
+			return false;
+		}
+		_offset[j] = k;
+		k += _sizes[j] * (ticks / _dec[j]); //samples of signal j in the batch
+	}
+	if (k > sizeof(_buf)) { //batch greater than buffer
+		return false;
+	}
+	if (!_port->attachTx(_id, _buf, k)) { //batch greater than packet
+		return false;
+	}
+	_size = k;
+	_ticks = ticks;
+	_tick = 0;
+	return true;
+}
+
+//Sample and write
+boolean HostTelemetry::update() {
+	if (_ticks == 0) { //not started
+		return false;
+	}
+	for (uint8_t j = 0; j < _numCh; j++) {
+		if ((_tick % _dec[j]) == 0) { //sample signal j
+			memcpy(_buf + _offset[j] + (_tick / _dec[j]) * _sizes[j], _ptr[j], _sizes[j]);
+		}
+	}
+	if (++_tick < _ticks) { //batch not complete yet
+		return false;
+	}
+	_tick = 0;
+	return _port->write(_id); //write the batch
+}
@@ -0,0 +1,96 @@
+#ifndef _HOSTTELEMETRY_H
+#define _HOSTTELEMETRY_H
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "HostPort.h"
+
+/*! \brief A class for batched telemetry with HostPort.
+	\details The class samples the attached signals at the loop rate divided by a decimation factor per signal,
+	and collects the samples of several loop iterations in a single packet, which is written with HostPort::write().
+	This reduces the number of writes to the serial (and of USB transactions) by the number of loop iterations per packet.
+	The batch packet is limited to HostPort::BUF_SIZE bytes, thus define HOSTPORT_BUF_SIZE as 512 at build time to fill the packets of the Teensy 4.1 high-speed USB.
+
+	The packet contains the samples of each signal one after the other, in the attaching order, oldest first. 
+	With a batch of `ticks` iterations, a signal with decimation `d` has `ticks/d` samples, thus the packet layout is fixed
+	and the host can decode it. The batch packet is attached to the HostPort as the transmit objects of a message ID.
+
+	The HostTelemetry object is created and used as
+
+	```c++
+	HostPort hostPort(&Serial, header, terminator);
+	HostTelemetry telemetry(&hostPort);
+	telemetry.attach((uint8_t*) &fastSignal, sizeof(fastSignal)); //sampled each iteration
+	telemetry.attach((uint8_t*) &slowSignal, sizeof(slowSignal), 10); //sampled each 10 iterations
+	telemetry.begin(10); //one packet each 10 iterations
+	while (1) {
+		//loop stuff here
+		telemetry.update(); //sample and write when the batch is complete
+	}
+	```
+
+	\see HostPort
+	\author Stefano Lovato
+	\date 2022
+*/
+class HostTelemetry {
+public:
+	/*! \brief Contructor.
+		\param port The pointer to the HostPort used to write the packets.
+		\param id The message ID of the packets. Use 0 when the message IDs are disabled.
+	*/
+	HostTelemetry(HostPort* port, uint8_t id = 0); //constructor
+
+	/*! \brief Attach signal.
+		\details The function attaches a signal, sampled once every `decimation` calls of HostTelemetry::update().
+		Signals must be attached before HostTelemetry::begin().
+		\param pointer The pointer to the signal to attach. Cast to uint8_t is required.
+		\param size The size of the signal to attach.
+		\param decimation The decimation factor of the signal (1 for no decimation).
+		\return True if success, false if the number of signals exceeds MAX_CHANNELS, the decimation is 0 or HostTelemetry::begin() was already called.
+		\see MAX_CHANNELS
+	*/
+	boolean attach(uint8_t* pointer, size_t size, uint16_t decimation = 1); //attach signal
+
+	/*! \brief Start the telemetry.
+		\details The function computes the packet layout and attaches the batch packet to the HostPort.
+		\param ticks The number of calls of HostTelemetry::update() for each packet. It must be a multiple of the decimation of all signals.
+		\return True if success, false if the ticks are not valid or the packet exceeds HostPort::BUF_SIZE.
+	*/
+	boolean begin(uint16_t ticks); //compute layout and attach batch to HostPort
+
+	/*! \brief Update the telemetry.
+		\details The function samples the signals whose decimation divides the current iteration, and writes the packet when complete.
+		It should be called once for each loop iteration.
+		\return True if a packet was written.
+	*/
+	boolean update(); //sample signals, write when the batch is complete
+
+	/*! \brief Packet size.
+		\return The number of data bytes of the batch packet, valid after HostTelemetry::begin().
+	*/
+	size_t size() const { return _size; } //batch packet bytes
+
+	//static constexpr
+	static constexpr uint8_t MAX_CHANNELS = 16; //!< Maximum signals. \details The number of maximum attached signals.
+
+private:
+	//vars
+	uint8_t _buf[HostPort::BUF_SIZE] = { 0 }; //!< Batch buffer. \details The buffer of the batch packet. \see begin
+	uint8_t* _ptr[MAX_CHANNELS] = { nullptr }; //!< Pointers to signals. \see attach
+	size_t _sizes[MAX_CHANNELS] = { 0 }; //!< Sizes of signals. \see attach
+	uint16_t _dec[MAX_CHANNELS] = { 0 }; //!< Decimation of signals. \see attach
+	size_t _offset[MAX_CHANNELS] = { 0 }; //!< Offsets of signals in the batch buffer. \details The offset of the first sample of each signal. \see begin
+	size_t _size = 0; //!< Size of the batch packet. \see begin
+	uint8_t _numCh = 0; //!< Number of attached signals. \see attach
+	uint16_t _ticks = 0; //!< Iterations per packet. \see begin
+	uint16_t _tick = 0; //!< Current iteration in the batch. \see update
+	uint8_t _id = 0; //!< Message ID of the packets.
+	HostPort* _port = nullptr; //!< Pointer to HostPort. \details The HostPort used to write the packets.
+};
+
+#endif
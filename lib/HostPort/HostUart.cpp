@@ -0,0 +1,130 @@
+#include "HostUart.h"
+
+#if defined(__IMXRT1062__)
+
+//LPUART, interrupt, interrupt handler and DMA request of a hardware serial (Teensy 4.0 and 4.1 pinout)
+struct UartMap {
+	HardwareSerial* serial;
+	IMXRT_LPUART_t* port;
+	IRQ_NUMBER_t irq;
+	void (*uart_isr)();
+	uint8_t dmamux;
+};
+
+static const UartMap UART_MAP[] = {
+	{ &Serial1, &IMXRT_LPUART6, IRQ_LPUART6, IRQHandler_Serial1, DMAMUX_SOURCE_LPUART6_RX },
+	{ &Serial2, &IMXRT_LPUART4, IRQ_LPUART4, IRQHandler_Serial2, DMAMUX_SOURCE_LPUART4_RX },
+	{ &Serial3, &IMXRT_LPUART2, IRQ_LPUART2, IRQHandler_Serial3, DMAMUX_SOURCE_LPUART2_RX },
+	{ &Serial4, &IMXRT_LPUART3, IRQ_LPUART3, IRQHandler_Serial4, DMAMUX_SOURCE_LPUART3_RX },
+	{ &Serial5, &IMXRT_LPUART8, IRQ_LPUART8, IRQHandler_Serial5, DMAMUX_SOURCE_LPUART8_RX },
+	{ &Serial6, &IMXRT_LPUART1, IRQ_LPUART1, IRQHandler_Serial6, DMAMUX_SOURCE_LPUART1_RX },
+	{ &Serial7, &IMXRT_LPUART7, IRQ_LPUART7, IRQHandler_Serial7, DMAMUX_SOURCE_LPUART7_RX },
+#if defined(ARDUINO_TEENSY41)
+	{ &Serial8, &IMXRT_LPUART5, IRQ_LPUART5, IRQHandler_Serial8, DMAMUX_SOURCE_LPUART5_RX },
+#endif
+};
+
+HostUart* HostUart::_uarts[MAX_UARTS] = { nullptr };
+
+//constructor
+HostUart::HostUart(HardwareSerial* serial) : HostRing(_ring, SIZE), _serial(serial) { }
+
+//start serial and DMA
+boolean HostUart::begin(uint32_t baud, uint16_t format) {
+	static void (*const UART_ISRS[MAX_UARTS])() = { uartIsrN<0>, uartIsrN<1>, uartIsrN<2>, uartIsrN<3>, uartIsrN<4>, uartIsrN<5>, uartIsrN<6>, uartIsrN<7> };
+	static void (*const DMA_ISRS[MAX_UARTS])() = { dmaIsrN<0>, dmaIsrN<1>, dmaIsrN<2>, dmaIsrN<3>, dmaIsrN<4>, dmaIsrN<5>, dmaIsrN<6>, dmaIsrN<7> };
+	int8_t idx = -1;
+	for (uint8_t i = 0; i < sizeof(UART_MAP) / sizeof(UART_MAP[0]); i++) {
+		if (UART_MAP[i].serial == _serial) idx = i;
+	}
+	if (idx < 0) { //not a hardware serial
+		return false;
+	}
+	end(); //restart if already started
+	const UartMap& map = UART_MAP[idx];
+	_serial->begin(baud, format);
+	NVIC_DISABLE_IRQ(map.irq);
+	_port = map.port;
+	_idx = idx;
+	_uarts[idx] = this;
+
+	//receive with DMA: the LPUART asks a transfer for each byte and the DMA channel writes the ring forever, interrupting at each half
+	_dma.disable();
+	_dma.source(*(volatile uint8_t*) &_port->DATA);
+	_dma.destinationCircular(_ring, SIZE);
+	_dma.triggerAtHardwareEvent(map.dmamux);
+	_dma.attachInterrupt(DMA_ISRS[idx]);
+	_dma.interruptAtHalf();
+	_dma.interruptAtCompletion();
+	_head = 0;
+	_tail = 0;
+	_halves = 0;
+	_produced = 0;
+	_dma.enable();
+
+	_port->CTRL &= ~(LPUART_CTRL_RIE | LPUART_CTRL_ILIE); //no receive interrupts of HardwareSerial
+	_port->WATER &= ~LPUART_WATER_RXWATER(3); //request as soon as one byte is in the FIFO
+	_port->BAUD |= LPUART_BAUD_RDMAE; //receive DMA request
+	attachInterruptVector(map.irq, UART_ISRS[idx]); //own the LPUART interrupt while the ring is active
+	NVIC_ENABLE_IRQ(map.irq);
+	return true;
+}
+
+//stop DMA and serial
+void HostUart::end() {
+	if (_port == nullptr) { //not started
+		return;
+	}
+	const UartMap& map = UART_MAP[_idx];
+	NVIC_DISABLE_IRQ(map.irq);
+	_port->BAUD &= ~LPUART_BAUD_RDMAE;
+	_dma.disable();
+	_dma.detachInterrupt();
+	attachInterruptVector(map.irq, map.uart_isr); //give back the interrupt to HardwareSerial
+	_uarts[_idx] = nullptr;
+	_port = nullptr;
+	_idx = -1;
+	_serial->end();
+}
+
+//DMA position
+size_t HostUart::head() {
+	constexpr size_t HALF = SIZE / 2;
+	uint32_t halves;
+	size_t pos;
+	do { //position and halves of the same half ring
+		halves = _halves;
+		pos = ((uintptr_t) _dma.TCD->DADDR - (uintptr_t) _ring) & _mask;
+	} while (halves != _halves);
+	size_t produced = halves * HALF + (pos & (HALF - 1));
+	if ((pos / HALF) != (halves & 1)) { //half completed, DMA interrupt not served yet
+		produced += HALF;
+	}
+	if ((((_head - _tail) & _mask) + (produced - _produced)) >= SIZE) { //DMA lapped the reader, bytes overwritten
+		_overflows++;
+		_tail = pos; //discard all
+	}
+	_produced = produced;
+	return pos;
+}
+
+//LPUART interrupt
+void HostUart::uartIsr() {
+	uint32_t ctrl = _port->CTRL;
+	uint32_t stat = _port->STAT;
+	if (((ctrl & LPUART_CTRL_TIE) && (stat & LPUART_STAT_TDRE)) || ((ctrl & LPUART_CTRL_TCIE) && (stat & LPUART_STAT_TC))) { //transmit events only, forwarded without waiting
+		UART_MAP[_idx].uart_isr();
+	}
+	if (_port->CTRL & (LPUART_CTRL_RIE | LPUART_CTRL_ILIE)) { //receive interrupts kept masked, pending bytes left to the DMA
+		_port->CTRL &= ~(LPUART_CTRL_RIE | LPUART_CTRL_ILIE);
+	}
+}
+
+//DMA interrupt
+void HostUart::dmaIsr() {
+	_dma.clearInterrupt();
+	_halves = _halves + 1;
+	asm("dsb"); //interrupt flag cleared before returning
+}
+
+#endif
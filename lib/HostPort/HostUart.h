@@ -0,0 +1,94 @@
+#ifndef _HOSTUART_H
+#define _HOSTUART_H
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include "HostRing.h"
+
+#if defined(__IMXRT1062__)
+#include <DMAChannel.h>
+
+/*! \brief A DMA receive ring for HostPort on the Teensy 4 hardware serials.
+	\details The class receives the bytes of a hardware serial (LPUART of the i.MX RT1062) with a DMA channel
+	writing in a circular buffer, without interrupts and without the receive buffer of HardwareSerial.
+	HostPort::read() then parses the packets directly from the ring, reading the DMA position once per call.
+	This is used for the high baudrate links (2-3 Mbaud), where the per-byte interrupt and virtual calls of HardwareSerial are significant.
+	The transmit is not changed and it is still performed by the HardwareSerial object: while the ring is active, the class owns the
+	interrupt vector of the LPUART and forwards only the transmit events to the interrupt handler of HardwareSerial, without waiting.
+	The receive interrupts stay masked and each received byte is moved by a DMA request a few bus cycles after its arrival,
+	so the receive FIFO is drained by the DMA and not by HardwareSerial.
+	The DMA channel interrupts at each half of the ring to count the bytes received, thus an overflow of the ring
+	(i.e. HostPort::read() not called for more than SIZE bytes) is detected, counted in HostRing::overflows() and the bytes overwritten are discarded.
+
+	The HostUart object is used with
+
+	```c++
+	HostUart uart(&Serial1);
+	HostPort hostPort(&Serial1, header, terminator);
+	uart.begin(3000000); //instead of Serial1.begin()
+	hostPort.setRing(&uart);
+	```
+
+	\tparam SIZE The size of the ring buffer, power of 2. At 3 Mbaud, 4096 bytes are received in about 14 ms.
+	\attention The HostUart object must be in the DTCM (i.e. a global or static variable, not DMAMEM or EXTMEM), which is not cached.
+	The HardwareSerial object must not be read when the HostUart is started.
+	\see HostRing HostPort::setRing
+	\author Stefano Lovato
+	\date 2022
+*/
+class HostUart : public HostRing {
+public:
+	//static constexpr
+	static constexpr size_t SIZE = 4096; //!< Ring buffer size. \details The size of the ring buffer, power of 2.
+
+	/*! \brief Contructor.
+		\param serial The pointer to one of the hardware serials, from Serial1 to Serial8.
+	*/
+	explicit HostUart(HardwareSerial* serial);
+
+	/*! \brief Start the serial and the DMA receive.
+		\details The function starts the hardware serial and then moves its receive to the DMA channel.
+		\param baud The baudrate.
+		\param format The format, as in HardwareSerial::begin().
+		\return True if success, false if the serial is not a hardware serial.
+	*/
+	boolean begin(uint32_t baud, uint16_t format = 0); //start serial and DMA
+
+	/*! \brief Stop the DMA receive and the serial.
+	*/
+	void end(void); //stop DMA and serial
+
+	/*! \brief Producer position.
+		\details The function also detects the overflows, discarding the bytes overwritten by the DMA channel.
+		\return The index of the next byte written by the DMA channel.
+	*/
+	size_t head(void) override; //DMA position
+
+private:
+	//static constexpr
+	static constexpr uint8_t MAX_UARTS = 8; //!< Maximum hardware serials.
+
+	//vars
+	alignas(SIZE) volatile uint8_t _ring[SIZE] = { 0 }; //!< Ring buffer. \details The ring buffer, aligned to its size for the DMA modulo addressing.
+	HardwareSerial* _serial = nullptr; //!< Pointer to the hardware serial.
+	IMXRT_LPUART_t* _port = nullptr; //!< LPUART registers of the serial.
+	DMAChannel _dma; //!< DMA channel.
+	int8_t _idx = -1; //!< Index of the hardware serial, -1 when not started.
+	volatile uint32_t _halves = 0; //!< Number of halves of the ring written by the DMA channel. \details Incremented by the DMA interrupt.
+	size_t _produced = 0; //!< Number of bytes written by the DMA channel at the latest head().
+	static HostUart* _uarts[MAX_UARTS]; //!< Started objects, by index of the hardware serial.
+
+	//functions
+	void uartIsr(void); //!< LPUART interrupt, transmit events forwarded to HardwareSerial.
+	void dmaIsr(void); //!< DMA interrupt, at each half of the ring.
+	template <uint8_t N> static void uartIsrN(void) { _uarts[N]->uartIsr(); } //!< LPUART interrupt of the N-th hardware serial.
+	template <uint8_t N> static void dmaIsrN(void) { _uarts[N]->dmaIsr(); } //!< DMA interrupt of the N-th hardware serial.
+};
+
+#endif
+
+#endif
@@ -0,0 +1,239 @@
+#ifndef _MODELBINDING_H
+#define _MODELBINDING_H
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#include <ratio>
+#include <limits>
+#include <type_traits>
+
+/*! \brief Bindings between the drivers and the model.
+	\details The conversions, the bindings and the lists of bindings (ModelBinding).
+	A conversion is a type with a static function `apply()`, which converts the source value to an arithmetic value.
+	The scale factors are template parameters (std::ratio), thus the conversions are constant expressions
+	inlined by the compiler in ModelBinding::apply(), without tables or function pointers.
+	Custom conversions are types with the same static function.
+
+	The conversions compute in the type Real of the source, i.e. float for the sources of at most 16 bits (e.g. the ADC codes) and the float sources,
+	double for the wider sources (e.g. int32_T, real_T), thus the value is exact within the precision of the source before it is stored
+	(rounded and saturated for the integer destinations).
+	\see ModelBinding
+*/
+namespace modelbinding {
+
+	/*! \brief Computation type.
+		\details The type of the conversions of a source type: float for the sources of at most 16 bits and float, double otherwise.
+		\tparam T The source type.
+	*/
+	template <typename T>
+	using Real = typename std::conditional<(sizeof(T) <= 2) || std::is_same<typename std::remove_cv<T>::type, float>::value, float, double>::type;
+
+	/*! \brief Identity conversion.
+		\details The value is converted to Real without scaling.
+	*/
+	struct Identity {
+		template <typename T>
+		static constexpr Real<T> apply(T x) { return static_cast<Real<T>>(x); } //!< Convert.
+	};
+
+	/*! \brief Linear conversion.
+		\details The value is converted as `x*Scale+Offset`, in Real.
+		\tparam Scale The scale factor, as std::ratio (e.g. `std::ratio<33, 40950>` for a 12-bit ADC with 3.3 V reference).
+		\tparam Offset The offset, as std::ratio.
+	*/
+	template <typename Scale, typename Offset = std::ratio<0>>
+	struct Linear {
+		template <typename T>
+		static constexpr Real<T> apply(T x) { //!< Convert.
+			return static_cast<Real<T>>(x) * (static_cast<Real<T>>(Scale::num) / Scale::den) + (static_cast<Real<T>>(Offset::num) / Offset::den);
+		}
+	};
+
+	/*! \brief Saturated conversion.
+		\details The value is converted with another conversion and limited between LO and HI (e.g. the range of a 12-bit DAC).
+		\tparam LO The lower limit.
+		\tparam HI The upper limit.
+		\tparam Conv The conversion before the saturation.
+	*/
+	template <intmax_t LO, intmax_t HI, typename Conv = Identity>
+	struct Clamp {
+		template <typename T>
+		static constexpr auto apply(T x) -> decltype(Conv::apply(x)) { //!< Convert.
+			return (Conv::apply(x) < LO) ? static_cast<decltype(Conv::apply(x))>(LO) : (Conv::apply(x) > HI) ? static_cast<decltype(Conv::apply(x))>(HI) : Conv::apply(x);
+		}
+	};
+
+}
+
+/*! \brief Helpers of ModelBinding.
+	\details Templates used by ModelBinding to store the converted values.
+	\see modelbinding::ModelBinding
+*/
+namespace modelbinding_detail {
+
+	//store in floating-point destination
+	template <typename D, typename V>
+	inline void store(D& dst, V val, std::true_type) {
+		dst = static_cast<D>(val);
+	}
+
+	//store in integer destination, rounded and saturated to the range of the type (integer values through double)
+	template <typename D, typename V>
+	inline void store(D& dst, V val, std::false_type) {
+		typedef typename std::remove_cv<D>::type T;
+		typedef typename std::conditional<std::is_floating_point<V>::value, V, double>::type R;
+		constexpr R lo = static_cast<R>(std::numeric_limits<T>::lowest());
+		constexpr R hi = static_cast<R>(std::numeric_limits<T>::max());
+		R x = static_cast<R>(val);
+		if (x <= lo) dst = std::numeric_limits<T>::lowest();
+		else if (x >= hi) dst = std::numeric_limits<T>::max();
+		else dst = static_cast<T>(x + ((x < 0) ? R(-0.5) : R(0.5)));
+	}
+
+	//store converted value
+	template <typename D, typename V>
+	inline void store(D& dst, V val) {
+		store(dst, val, std::is_floating_point<typename std::remove_cv<D>::type>());
+	}
+
+}
+
+namespace modelbinding {
+
+	/*! \brief A binding of a source value to a destination.
+		\details The binding converts the source with the conversion `Conv` and writes the destination. Use bind() to create it.
+		\tparam Conv The conversion.
+		\tparam D The destination type.
+		\tparam S The source type.
+		\see bind ModelBinding
+	*/
+	template <typename Conv, typename D, typename S>
+	struct Binding {
+		D* dst; //!< Destination.
+		const S* src; //!< Source.
+		inline void apply() const { modelbinding_detail::store(*dst, Conv::apply(*src)); } //!< Convert source into destination.
+	};
+
+	/*! \brief Create a binding.
+		\details The function creates a binding of a source value to a destination with the conversion `Conv`.
+		\tparam Conv The conversion (default Identity).
+		\param dst The pointer to the destination (e.g. a field of the model inputs or an actuator command).
+		\param src The pointer to the source (e.g. a sensor reading or a field of the model outputs).
+		\return The binding.
+	*/
+	template <typename Conv = Identity, typename D, typename S>
+	constexpr Binding<Conv, D, S> bind(D* dst, const S* src) { return Binding<Conv, D, S>{ dst, src }; }
+
+	/*! \brief A list of bindings between the drivers and the model.
+		\details The class applies a list of bindings, mapping the sensor readings (IMU, ADC, SBUS...) directly into the fields of the model inputs
+		and the fields of the model outputs directly into the actuator commands (DAC, steppers...). The list is a type, thus ModelBinding::apply()
+		is unrolled at compile-time, with the conversions inlined, and it replaces both the copy to a ExtU_controlModel_T struct with setExternalInputs()
+		and the copy from getExternalOutputs() to the driver buffers.
+
+		The ModelBinding objects are created using bindings() and used as
+
+		```c++
+		using namespace modelbinding;
+		uint16_t adcRaw[2]; //ADC readings
+		uint16_t dacCode; //DAC command
+		auto inputs = bindings(
+			bind<Linear<std::ratio<33, 40950>>>(&model.controlModel_U.input1, &adcRaw[0]), //12-bit ADC to V
+			bind<Linear<std::ratio<33, 40950>>>(&model.controlModel_U.input2, &adcRaw[1]));
+		auto outputs = bindings(
+			bind<Clamp<0, 4095, Linear<std::ratio<40950, 33>>>>(&dacCode, &model.controlModel_Y.output1)); //V to 12-bit DAC
+		...
+		inputs.applyAtomic(scheduler.priority(sensorTask)); //sensors to model, with the sensor task masked
+		model.update();
+		outputs.applyAtomic(scheduler.priority(sensorTask)); //model to actuators
+		```
+
+		Drivers writing floats to scattered destinations (e.g. SbusRx::ch_norm()) can write directly into the model inputs, without a binding.
+
+		\tparam Bs The types of the bindings.
+		\attention The inputs should be applied in the same task of the model step, before it, so that the model reads consistent inputs.
+		When the sources are written by a task preempting the model task (e.g. a faster sensor task), or the destinations are read by it,
+		ModelBinding::apply() may mix values of two runs of that task (e.g. `adcRaw[0]` new and `adcRaw[1]` old): use ModelBinding::applyAtomic(),
+		which applies the bindings with that task masked, thus from a consistent snapshot.
+		\see bind bindings
+		\author Stefano Lovato
+		\date 2022
+	*/
+	template <typename... Bs>
+	class ModelBinding {
+	public:
+		/*! \brief Apply the bindings.
+			\details The function converts all the sources into the destinations.
+		*/
+		inline void apply() const { } //apply
+
+		/*! \brief Apply the bindings atomically.
+			\details The function converts all the sources into the destinations with the interrupts masked.
+			\param priority The NVIC priority to mask.
+		*/
+		inline void applyAtomic(uint8_t priority = 0) const { (void) priority; } //apply atomically
+	};
+
+	template <typename B, typename... Bs>
+	class ModelBinding<B, Bs...> {
+	public:
+		/*! \brief Contructor.
+			\param first The first binding.
+			\param rest The other bindings.
+		*/
+		constexpr ModelBinding(const B& first, const Bs&... rest) : _first(first), _rest(rest...) { } //constructor
+
+		/*! \brief Apply the bindings.
+			\details The function converts all the sources into the destinations, in the list order.
+		*/
+		inline void apply() const { _first.apply(); _rest.apply(); } //apply
+
+		/*! \brief Apply the bindings atomically.
+			\details The function converts all the sources into the destinations, in the list order, with the interrupts masked,
+			thus the tasks writing the sources or reading the destinations do not run meanwhile. The bindings take a few cycles each.
+			With a priority, only the interrupts with that NVIC priority or a lower one (greater value) are masked, raising BASEPRI:
+			pass the priority of the preempting task (e.g. RateScheduler::priority() of the sensor task), so that the interrupts above it
+			(e.g. the serials and the USB) are not delayed. Without a priority (0), all the interrupts are masked (PRIMASK).
+			In both cases the previous mask is restored on return, thus the function can be called with the interrupts already masked.
+			\param priority The NVIC priority of the preempting task, 0 to mask all the interrupts.
+		*/
+		inline void applyAtomic(uint8_t priority = 0) const { //apply atomically
+#if defined(__arm__)
+			uint32_t mask;
+			if (priority == 0) {
+				__asm__ volatile("mrs %0, primask" : "=r" (mask));
+				__asm__ volatile("cpsid i" ::: "memory");
+				apply();
+				__asm__ volatile("msr primask, %0" :: "r" (mask) : "memory");
+			}
+			else {
+				__asm__ volatile("mrs %0, basepri" : "=r" (mask));
+				__asm__ volatile("msr basepri_max, %0" :: "r" ((uint32_t) priority) : "memory"); //raised only, never lowered
+				apply();
+				__asm__ volatile("msr basepri, %0" :: "r" (mask) : "memory");
+			}
+#else
+			(void) priority;
+			apply(); //no interrupts on the host
+#endif
+		}
+
+	private:
+		B _first; //!< First binding.
+		ModelBinding<Bs...> _rest; //!< Other bindings.
+	};
+
+	/*! \brief Create a list of bindings.
+		\details The function creates a ModelBinding from the bindings.
+		\param bs The bindings, created with bind().
+		\return The list of bindings.
+	*/
+	template <typename... Bs>
+	constexpr ModelBinding<Bs...> bindings(const Bs&... bs) { return ModelBinding<Bs...>(bs...); }
+
+}
+
+#endif
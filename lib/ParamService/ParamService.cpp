@@ -0,0 +1,161 @@
+#include "ParamService.h"
+#include <limits>
+
+//convert and write a value with the field type, rounded and saturated for the integer types
+template <typename T>
+static inline void writeAs(uint8_t* dst, float value) {
+	T val;
+	if (!std::numeric_limits<T>::is_integer) val = static_cast<T>(value);
+	else if (value != value) val = 0; //NaN
+	else if (value <= static_cast<float>(std::numeric_limits<T>::lowest())) val = std::numeric_limits<T>::lowest();
+	else if (value >= static_cast<float>(std::numeric_limits<T>::max())) val = std::numeric_limits<T>::max();
+	else val = static_cast<T>(value + ((value < 0) ? -0.5f : 0.5f));
+	memcpy(dst, &val, sizeof(T));
+}
+
+//read a value with the field type and convert
+template <typename T>
+static inline float readAs(const uint8_t* src) {
+	T val;
+	memcpy(&val, src, sizeof(T));
+	return static_cast<float>(val);
+}
+
+//constructor
+ParamService::ParamService(void* params, size_t size, const ParamField* fields, uint16_t numFields) :
+	ParamService(params, size, fields, numFields, fieldOf<ParamField>) { }
+
+//constructor with the table reader
+ParamService::ParamService(void* params, size_t size, const void* fields, uint16_t numFields, ParamField (*fieldOf)(const void*, uint16_t)) :
+	_params((uint8_t*) params), _size(size), _fields(fields), _numFields(numFields), _fieldOf(fieldOf) { }
+
+//start
+boolean ParamService::begin() {
+	if ((_params == nullptr) || (_size > MAX_SIZE)) return false;
+	for (uint16_t i = 0; i < _numFields; ++i) {
+		ParamField f = _fieldOf(_fields, i);
+		size_t size = typeSize(f.type);
+		if ((size == 0) || (f.offset + size * f.count > _size)) return false; //field out of struct
+	}
+	memcpy(_copies[0], _params, _size);
+	memcpy(_copies[1], _params, _size);
+	_front = 0;
+	_pending = false;
+	_staged = false;
+	_version = 0;
+	_started = true;
+	return true;
+}
+
+//get field
+ParamField ParamService::field(int16_t index) const {
+	if ((index < 0) || (index >= _numFields)) return ParamField{ nullptr, 0, 0, 0 };
+	return _fieldOf(_fields, index);
+}
+
+//find field
+int16_t ParamService::find(const char* name) const {
+	if (name == nullptr) return NOT_FOUND;
+	for (uint16_t i = 0; i < _numFields; ++i) {
+		if (strcmp(_fieldOf(_fields, i).name, name) == 0) return i;
+	}
+	return NOT_FOUND;
+}
+
+//stage raw value
+boolean ParamService::stageBytes(int16_t index, const void* value, uint16_t element) {
+	uint8_t* dst = backElement(index, element);
+	if ((dst == nullptr) || (value == nullptr)) return false;
+	memcpy(dst, value, typeSize(_fieldOf(_fields, index).type));
+	_staged = true;
+	return true;
+}
+
+//stage value
+boolean ParamService::stage(int16_t index, float value, uint16_t element) {
+	uint8_t* dst = backElement(index, element);
+	if (dst == nullptr) return false;
+	switch (_fieldOf(_fields, index).type) {
+		case ParamField::REAL32: writeAs<float>(dst, value); break;
+		case ParamField::REAL64: writeAs<double>(dst, value); break;
+		case ParamField::INT8: writeAs<int8_t>(dst, value); break;
+		case ParamField::UINT8: writeAs<uint8_t>(dst, value); break;
+		case ParamField::INT16: writeAs<int16_t>(dst, value); break;
+		case ParamField::UINT16: writeAs<uint16_t>(dst, value); break;
+		case ParamField::INT32: writeAs<int32_t>(dst, value); break;
+		case ParamField::UINT32: writeAs<uint32_t>(dst, value); break;
+		case ParamField::BOOLEAN: writeAs<uint8_t>(dst, (value != 0) ? 1 : 0); break;
+		default: return false;
+	}
+	_staged = true;
+	return true;
+}
+
+//get value
+float ParamService::get(int16_t index, uint16_t element) const {
+	if ((index < 0) || (index >= _numFields)) return NAN;
+	ParamField f = _fieldOf(_fields, index);
+	if (element >= f.count) return NAN;
+	const uint8_t* src = _params + f.offset + element * typeSize(f.type);
+	switch (f.type) {
+		case ParamField::REAL32: return readAs<float>(src);
+		case ParamField::REAL64: return readAs<double>(src);
+		case ParamField::INT8: return readAs<int8_t>(src);
+		case ParamField::UINT8: return readAs<uint8_t>(src);
+		case ParamField::INT16: return readAs<int16_t>(src);
+		case ParamField::UINT16: return readAs<uint16_t>(src);
+		case ParamField::INT32: return readAs<int32_t>(src);
+		case ParamField::UINT32: return readAs<uint32_t>(src);
+		case ParamField::BOOLEAN: return readAs<uint8_t>(src);
+		default: return NAN;
+	}
+}
+
+//commit staged values
+boolean ParamService::commit() {
+	if (!_started || !_staged) return false;
+	uint8_t back = 1 - _front;
+	__sync_synchronize(); //staged values written before publishing
+	_front = back; //swap copies
+	_pending = true;
+	memcpy(_copies[1 - back], _copies[back], _size); //new back copy from the published one
+	_staged = false;
+	return true;
+}
+
+//discard staged values
+void ParamService::discard() {
+	if (!_started) return;
+	memcpy(_copies[1 - _front], _copies[_front], _size);
+	_staged = false;
+}
+
+//apply committed values
+boolean ParamService::apply() {
+	if (!_pending) return false;
+	__sync_synchronize(); //published copy read after the flag
+	memcpy(_params, _copies[_front], _size);
+	_pending = false;
+	++_version;
+	return true;
+}
+
+//size of type
+size_t ParamService::typeSize(uint8_t type) {
+	switch (type) {
+		case ParamField::REAL32: return 4;
+		case ParamField::REAL64: return 8;
+		case ParamField::INT8: case ParamField::UINT8: case ParamField::BOOLEAN: return 1;
+		case ParamField::INT16: case ParamField::UINT16: return 2;
+		case ParamField::INT32: case ParamField::UINT32: return 4;
+		default: return 0;
+	}
+}
+
+//pointer to an element in the back copy
+uint8_t* ParamService::backElement(int16_t index, uint16_t element) {
+	if (!_started || (index < 0) || (index >= _numFields)) return nullptr;
+	ParamField f = _fieldOf(_fields, index);
+	if (element >= f.count) return nullptr;
+	return _copies[1 - _front] + f.offset + element * typeSize(f.type);
+}
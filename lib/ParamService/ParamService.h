@@ -0,0 +1,203 @@
+#ifndef _PARAMSERVICE_H
+#define _PARAMSERVICE_H
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+/*! \brief A field of a parameter struct.
+	\details The description of a field of the parameter struct of the model (e.g. `params_type params`).
+	The table generated by gencode.m in `modelname_params.h` has its own field type, with the same members and type values,
+	and it is read through the template constructor of ParamService, thus the generated code does not depend on this library.
+	\see ParamService
+*/
+struct ParamField {
+	/*! \brief Field types.
+		\details The types of the fields, as the types of rtwtypes.h.
+	*/
+	enum Type : uint8_t {
+		REAL32 = 0, //!< real32_T (float).
+		REAL64, //!< real_T, real64_T (double).
+		INT8, //!< int8_T.
+		UINT8, //!< uint8_T.
+		INT16, //!< int16_T.
+		UINT16, //!< uint16_T.
+		INT32, //!< int32_T.
+		UINT32, //!< uint32_T.
+		BOOLEAN, //!< boolean_T.
+	};
+	const char* name; //!< Name of the field.
+	uint16_t offset; //!< Offset of the field in the struct (bytes).
+	uint8_t type; //!< Type of the field. \see Type
+	uint16_t count; //!< Number of elements (1 for scalars).
+};
+
+/*! \brief A class for the online tuning of the model parameters.
+	\details The class exposes each field of the parameter struct of the model by name, offset and type (ParamField),
+	and changes them without regenerating the code. The new values are staged in a back copy of the parameters, and
+	ParamService::commit() publishes the back copy in a single step, swapping the two copies. ParamService::apply() then copies
+	the published values into the parameters of the model, and it is called in the task of the model step before the step,
+	thus the model never sees a partial update (e.g. a gain changed and the related one not yet).
+
+	The ParamService object is created from the fields generated in `modelname_params.h` and used as
+
+	```c++
+	ParamService paramService(controlModel_params{});
+	paramService.begin();
+	//model task (e.g. the before hook of controlModel_rates::addTasks)
+	paramService.apply(); //apply the committed values, if any
+	model.update();
+	//background (e.g. on a message from the host)
+	paramService.stage(paramService.find("gain"), 2.5f); //stage a value
+	paramService.commit(); //publish staged values, applied before the next step
+	```
+
+	\attention ParamService::stage() and ParamService::commit() must be called from a task with lower priority than the model task (e.g. the background),
+	and ParamService::apply() only from the model task.
+	\see ParamField
+	\author Stefano Lovato
+	\date 2022
+*/
+class ParamService {
+public:
+	//static constexpr
+	static constexpr size_t MAX_SIZE = 512; //!< Maximum size. \details The maximum size of the parameter struct, i.e. the size of each copy.
+	static constexpr int16_t NOT_FOUND = -1; //!< Field not found. \details The value returned by ParamService::find() when the field is not found.
+
+	/*! \brief Contructor.
+		\param params The pointer to the parameter struct of the model.
+		\param size The size of the parameter struct.
+		\param fields The pointer to the fields of the parameter struct (e.g. `modelname_params::fields()`).
+		\param numFields The number of fields.
+	*/
+	ParamService(void* params, size_t size, const ParamField* fields, uint16_t numFields); //constructor
+
+	/*! \brief Contructor from the generated fields.
+		\details The parameters, size and fields are taken from the struct generated by gencode.m in `modelname_params.h`,
+		whose field table (`P::field_T`, i.e. name, offset, type and count) and type values (e.g. `P::REAL32`) match ParamField,
+		as checked at compile time.
+		\tparam P The struct of the generated fields (e.g. `controlModel_params`).
+	*/
+	template <typename P>
+	explicit ParamService(const P&) : ParamService(P::data(), P::SIZE, P::fields(), P::NUM_FIELDS, fieldOf<typename P::field_T>) { //constructor from the generated fields
+		static_assert(((uint8_t) P::REAL32 == ParamField::REAL32) && ((uint8_t) P::REAL64 == ParamField::REAL64) && ((uint8_t) P::INT8 == ParamField::INT8) &&
+			((uint8_t) P::UINT8 == ParamField::UINT8) && ((uint8_t) P::INT16 == ParamField::INT16) && ((uint8_t) P::UINT16 == ParamField::UINT16) &&
+			((uint8_t) P::INT32 == ParamField::INT32) && ((uint8_t) P::UINT32 == ParamField::UINT32) && ((uint8_t) P::BOOLEAN == ParamField::BOOLEAN),
+			"the generated field types differ from ParamField::Type");
+	}
+
+	/*! \brief Start the service.
+		\details The function initializes both copies with the current parameters.
+		\return True if success, false if the size exceeds MAX_SIZE or a field exceeds the size.
+		\see MAX_SIZE
+	*/
+	boolean begin(); //start
+
+	/*! \brief Number of fields.
+		\return The number of fields.
+	*/
+	uint16_t count() const { return _numFields; } //number of fields
+
+	/*! \brief Get field.
+		\param index The field index.
+		\return The field, with a null name for an invalid index.
+	*/
+	ParamField field(int16_t index) const; //get field
+
+	/*! \brief Find field.
+		\details The function finds a field by name.
+		\param name The field name.
+		\return The field index, or NOT_FOUND if not found.
+	*/
+	int16_t find(const char* name) const; //find field
+
+	/*! \brief Stage raw value.
+		\details The function stages the raw bytes of an element of a field, with the field type.
+		\param index The field index.
+		\param value The pointer to the value, with the size of the field type.
+		\param element The element index, for the array fields.
+		\return True if success, false for an invalid field or element or if not started.
+	*/
+	boolean stageBytes(int16_t index, const void* value, uint16_t element = 0); //stage raw value
+
+	/*! \brief Stage value.
+		\details The function stages an element of a field, converting the value to the field type (rounded for the integer types).
+		\param index The field index.
+		\param value The value.
+		\param element The element index, for the array fields.
+		\return True if success, false for an invalid field or element or if not started.
+	*/
+	boolean stage(int16_t index, float value, uint16_t element = 0); //stage value
+
+	/*! \brief Get value.
+		\details The function gets an element of a field from the parameters of the model, converted to float.
+		\param index The field index.
+		\param element The element index, for the array fields.
+		\return The value, or NAN for an invalid field or element.
+	*/
+	float get(int16_t index, uint16_t element = 0) const; //get value
+
+	/*! \brief Commit staged values.
+		\details The function publishes the staged values, which are applied by the next ParamService::apply().
+		\return True if success, false if no value is staged.
+	*/
+	boolean commit(); //commit staged values
+
+	/*! \brief Discard staged values.
+		\details The function discards the values staged after the last commit.
+	*/
+	void discard(); //discard staged values
+
+	/*! \brief Apply committed values.
+		\details The function copies the committed values into the parameters of the model. Call in the model task, between two steps.
+		\return True if the values are applied, false if no value is committed.
+	*/
+	boolean apply(); //apply committed values
+
+	/*! \brief Get version.
+		\details The function gets the number of commits applied since ParamService::begin().
+		\return The version.
+	*/
+	uint32_t version() const { return _version; } //get version
+
+	/*! \brief Get size of type.
+		\param type The field type.
+		\return The size of the type in bytes, 0 for an invalid type.
+		\see ParamField::Type
+	*/
+	static size_t typeSize(uint8_t type); //size of type
+
+private:
+	//vars
+	uint8_t* _params; //!< Parameters of the model.
+	size_t _size; //!< Size of the parameters.
+	const void* _fields; //!< Fields of the parameters, ParamField or generated.
+	uint16_t _numFields; //!< Number of fields.
+	ParamField (*_fieldOf)(const void*, uint16_t); //!< Read a field of the table.
+	uint8_t _copies[2][MAX_SIZE]; //!< Published and back copies.
+	volatile uint8_t _front = 0; //!< Index of the published copy.
+	volatile boolean _pending = false; //!< True when committed and not applied.
+	boolean _staged = false; //!< True when the back copy has staged values.
+	volatile uint32_t _version = 0; //!< Number of applied commits.
+	boolean _started = false; //!< True when started.
+
+	//functions
+	ParamService(void* params, size_t size, const void* fields, uint16_t numFields, ParamField (*fieldOf)(const void*, uint16_t)); //!< Constructor with the table reader.
+	uint8_t* backElement(int16_t index, uint16_t element); //!< Pointer to an element in the back copy, nullptr if invalid.
+
+	/*! \brief Read a field of a table.
+		\tparam F The field type of the table, with the members of ParamField.
+		\param fields The table.
+		\param index The field index.
+		\return The field.
+	*/
+	template <typename F>
+	static ParamField fieldOf(const void* fields, uint16_t index) {
+		const F& f = static_cast<const F*>(fields)[index];
+		return ParamField{ f.name, f.offset, f.type, f.count };
+	}
+};
+
+#endif
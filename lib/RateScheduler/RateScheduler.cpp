@@ -0,0 +1,159 @@
+#include "RateScheduler.h"
+
+#if defined(__IMXRT1062__)
+
+//reserved interrupts of the i.MX RT1062, used as software interrupts (IRQ_SOFTWARE is used by the audio library and EventResponder)
+const uint8_t RateScheduler::IRQS[MAX_TASKS] = { IRQ_Reserved1, IRQ_Reserved2, IRQ_Reserved3, IRQ_Reserved4, IRQ_Reserved5, IRQ_Reserved6 };
+
+RateScheduler* RateScheduler::_instance = nullptr;
+
+//constructor
+RateScheduler::RateScheduler(uint32_t tickMicros) : _tick(tickMicros) { }
+
+//add periodic task
+int8_t RateScheduler::addTask(TaskFunction fn, uint32_t periodMicros, uint32_t offsetMicros) {
+	if (_started || (_numTasks >= MAX_TASKS) || (fn == nullptr) || (_tick == 0)) return -1;
+	if ((periodMicros == 0) || (periodMicros % _tick) || (offsetMicros % _tick)) return -1; //not multiple of the tick
+	Task& task = _tasks[_numTasks];
+	task.fn = fn;
+	task.period = periodMicros / _tick;
+	task.countdown = offsetMicros / _tick + 1; //first release at the tick after the offset
+	task.irq = IRQS[_numTasks];
+	return _numTasks++;
+}
+
+//add background task
+boolean RateScheduler::addBackground(TaskFunction fn) {
+	if ((_numBackground >= MAX_BACKGROUND) || (fn == nullptr)) return false;
+	_background[_numBackground++] = fn;
+	return true;
+}
+
+//start
+boolean RateScheduler::begin(uint8_t priority) {
+	static void (* const ISRS[MAX_TASKS])() = { taskIsr<0>, taskIsr<1>, taskIsr<2>, taskIsr<3>, taskIsr<4>, taskIsr<5> };
+	if (_started || (_numTasks == 0) || (_instance != nullptr)) return false;
+	//count distinct periods
+	uint8_t levels = 0;
+	for (uint8_t i = 0; i < _numTasks; ++i) {
+		boolean found = false;
+		for (uint8_t j = 0; j < i; ++j) found |= (_tasks[j].period == _tasks[i].period);
+		if (!found) ++levels;
+	}
+	if (priority % 16) return false; //not an NVIC priority level, the lower 4 bits are ignored
+	if ((priority <= 128) || (priority + 16 * (levels - 1) > 255)) return false; //tasks at or above the serials and USB, or no room for the slowest
+	//rate-monotonic priorities: one level for each distinct period, the shorter the period, the higher the priority
+	for (uint8_t i = 0; i < _numTasks; ++i) {
+		uint8_t faster = 0; //distinct periods shorter than this
+		for (uint8_t j = 0; j < _numTasks; ++j) {
+			if (_tasks[j].period >= _tasks[i].period) continue;
+			boolean found = false;
+			for (uint8_t k = 0; k < j; ++k) found |= (_tasks[k].period == _tasks[j].period);
+			if (!found) ++faster;
+		}
+		_tasks[i].priority = priority + 16 * faster;
+		attachInterruptVector((IRQ_NUMBER_t) _tasks[i].irq, ISRS[i]);
+		NVIC_SET_PRIORITY(_tasks[i].irq, _tasks[i].priority);
+		NVIC_ENABLE_IRQ(_tasks[i].irq);
+	}
+	//start tick, above all tasks
+	_instance = this;
+	_ticks = 0;
+	_timer.priority(priority - 16);
+	if (!_timer.begin(tickIsr, _tick)) {
+		_instance = nullptr;
+		return false;
+	}
+	_started = true;
+	return true;
+}
+
+//stop
+void RateScheduler::end() {
+	if (!_started) return;
+	_timer.end();
+	for (uint8_t i = 0; i < _numTasks; ++i) {
+		while (_tasks[i].busy); //wait pending and running tasks
+		NVIC_DISABLE_IRQ(_tasks[i].irq);
+	}
+	_instance = nullptr;
+	_started = false;
+}
+
+//run background tasks forever
+void RateScheduler::run() {
+	while (1) idle();
+}
+
+//run background tasks once
+void RateScheduler::idle() {
+	for (uint8_t i = 0; i < _numBackground; ++i) _background[i]();
+}
+
+//get task priority
+uint8_t RateScheduler::priority(int8_t task) const {
+	if (!_started || (task < 0) || (task >= _numTasks)) return 0;
+	return _tasks[task].priority;
+}
+
+//get task statistics
+RateScheduler::Stats RateScheduler::stats(int8_t task) const {
+	Stats stats;
+	if ((task < 0) || (task >= _numTasks)) return stats;
+	__disable_irq();
+	stats = _tasks[task].stats;
+	__enable_irq();
+	return stats;
+}
+
+//reset statistics
+void RateScheduler::resetStats() {
+	__disable_irq();
+	for (uint8_t i = 0; i < _numTasks; ++i) _tasks[i].stats = Stats();
+	__enable_irq();
+}
+
+//base tick interrupt
+void RateScheduler::tickIsr() {
+	_instance->tick();
+}
+
+//release tasks
+void RateScheduler::tick() {
+	++_ticks;
+	for (uint8_t i = 0; i < _numTasks; ++i) {
+		Task& task = _tasks[i];
+		if (--task.countdown) continue;
+		task.countdown = task.period;
+		++task.stats.releases;
+		if (task.busy) { //deadline missed, skip release
+			++task.stats.overruns;
+			continue;
+		}
+		task.busy = true;
+		task.release = ARM_DWT_CYCCNT;
+		NVIC_SET_PENDING(task.irq);
+	}
+}
+
+//run task
+void RateScheduler::execute(uint8_t index) {
+	Task& task = _tasks[index];
+	uint32_t nested = _nested;
+	uint32_t start = ARM_DWT_CYCCNT;
+	task.fn();
+	__disable_irq();
+	uint32_t stop = ARM_DWT_CYCCNT;
+	uint32_t exec = (stop - start) - (_nested - nested); //remove the time of the preempting tasks
+	uint32_t response = stop - task.release;
+	_nested += exec; //seen as preemption time by the preempted tasks
+	Stats& stats = task.stats;
+	++stats.runs;
+	stats.last = exec;
+	if (exec > stats.wcet) stats.wcet = exec;
+	if (response > stats.response) stats.response = response;
+	task.busy = false;
+	__enable_irq();
+}
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef _RATESCHEDULER_H
+#define _RATESCHEDULER_H
+
+#if ARDUINO >= 100
+#include "Arduino.h"
+#else
+#include "WProgram.h"
+#endif
+
+#if defined(__IMXRT1062__)
+
+/*! \brief A fixed-priority preemptive scheduler for periodic tasks on the Teensy 4.
+	\details The class runs periodic tasks at fixed rates from a hardware timer, instead of pacing a `while(1)` loop with micros().
+	A base tick (IntervalTimer) releases the tasks whose period is elapsed, and each task runs in its own software interrupt
+	(one of the reserved NVIC interrupts of the i.MX RT1062), thus a faster task preempts a slower one and the timing of a task
+	does not depend on the tasks with lower rate, nor on the background code.
+
+	The priorities are assigned rate-monotonic in RateScheduler::begin(), i.e. the shorter the period, the higher the priority:
+	the fastest tasks take the given priority, each slower rate the next lower one (16 more) and the base tick the next higher one (16 less).
+	All the tasks are below the hardware interrupts with the default priority 128 (e.g. the serials and the USB), which
+	still preempt all the tasks, thus the tasks must not wait for them. Tasks with period 0 are background tasks, which run in turn
+	in the main context by RateScheduler::run().
+
+	A task is overrun when it is released while its previous execution is not completed (i.e. it missed its deadline): the release is skipped
+	and counted. For each task the execution time is measured with the cycle counter, excluding the time of the preempting tasks, and the worst case is recorded.
+
+	The RateScheduler object is used as
+
+	```c++
+	RateScheduler scheduler(250); //4 kHz base tick
+	scheduler.addTask(sensorTask, 250); //4 kHz
+	scheduler.addTask(controlTask, 1000); //1 kHz
+	scheduler.addTask(telemetryTask, 10000); //100 Hz
+	scheduler.addBackground(flushTask); //background
+	scheduler.begin();
+	scheduler.run(); //background tasks, running forever
+	```
+
+	\attention Only one RateScheduler can be started. The task functions run in interrupt context, thus the data shared with other tasks
+	or with the background must be volatile and read consistently (e.g. with the interrupts disabled).
+	\author Stefano Lovato
+	\date 2022
+*/
+class RateScheduler {
+public:
+	//static constexpr
+	static constexpr uint8_t MAX_TASKS = 6; //!< Maximum periodic tasks. \details The number of maximum periodic tasks, equal to the reserved NVIC interrupts used as software interrupts.
+	static constexpr uint8_t MAX_BACKGROUND = 4; //!< Maximum background tasks. \details The number of maximum background tasks.
+	static constexpr uint8_t DEFAULT_PRIORITY = 160; //!< Default priority. \details The default NVIC priority of the fastest tasks, with the base tick at 144, below the default priority of the hardware serials and USB (128).
+
+	//typedef
+	typedef void (*TaskFunction)(void); //!< Task function. \details The function of a task, without arguments and return.
+
+	/*! \brief Task statistics.
+		\details The statistics of a periodic task. The times are in CPU cycles. \see stats cyclesToMicros
+	*/
+	struct Stats {
+		uint32_t releases = 0; //!< Releases. \details The number of releases of the task, i.e. the number of elapsed periods.
+		uint32_t runs = 0; //!< Runs. \details The number of completed executions of the task.
+		uint32_t overruns = 0; //!< Overruns. \details The number of releases skipped because the previous execution was not completed.
+		uint32_t last = 0; //!< Last execution time. \details The execution time of the last run, excluding the preempting tasks.
+		uint32_t wcet = 0; //!< Worst-case execution time. \details The maximum execution time, excluding the preempting tasks.
+		uint32_t response = 0; //!< Worst-case response time. \details The maximum time from the release to the completion, including the preemptions.
+	};
+
+	/*! \brief Contructor.
+		\param tickMicros The base tick period in us. The task periods and offsets are multiples of the base tick.
+	*/
+	RateScheduler(uint32_t tickMicros); //constructor
+
+	/*! \brief Add periodic task.
+		\details The function adds a periodic task. Tasks must be added before RateScheduler::begin().
+		\param fn The task function.
+		\param periodMicros The period of the task in us, multiple of the base tick.
+		\param offsetMicros The offset of the first release in us, multiple of the base tick. Use to distribute tasks with the same period over the ticks.
+		\return The task index, used by RateScheduler::stats(), or -1 if the number of tasks exceeds MAX_TASKS, the period is not valid or RateScheduler::begin() was already called.
+		\see MAX_TASKS
+	*/
+	int8_t addTask(TaskFunction fn, uint32_t periodMicros, uint32_t offsetMicros = 0); //add periodic task
+
+	/*! \brief Add background task.
+		\details The function adds a background task, which runs in the main context by RateScheduler::run() and RateScheduler::idle().
+		\param fn The task function.
+		\return True if success, false if the number of background tasks exceeds MAX_BACKGROUND.
+		\see MAX_BACKGROUND
+	*/
+	boolean addBackground(TaskFunction fn); //add background task
+
+	/*! \brief Start the scheduler.
+		\details The function assigns the priorities (rate-monotonic) and the interrupts of the tasks, and starts the base tick.
+		The fastest tasks have priority `priority`, the slowest tasks `priority+16*(n-1)`, with `n` the number of distinct periods, and the base tick `priority-16`.
+		\param priority The NVIC priority of the fastest tasks, multiple of 16 and greater than 128 (lower than the serials and USB).
+		\return True if success, false if no periodic task is added, the priority is not a multiple of 16 (only the upper 4 bits are implemented)
+		or not greater than 128 (i.e. the same as or above the serials and USB), there is no room for the slowest tasks (above 255),
+		another scheduler is running or no timer is available.
+	*/
+	boolean begin(uint8_t priority = DEFAULT_PRIORITY); //start
+
+	/*! \brief Stop the scheduler.
+		\details The function stops the base tick. The tasks in execution are completed.
+	*/
+	void end(); //stop
+
+	/*! \brief Run the background tasks.
+		\details The function runs the background tasks in turn, forever. This replaces the infinite loop in main().
+	*/
+	void run(); //run background tasks forever
+
+	/*! \brief Run the background tasks once.
+		\details The function runs each background task once. Use when the infinite loop is in the user code.
+	*/
+	void idle(); //run background tasks once
+
+	/*! \brief Get task statistics.
+		\details The function copies the statistics of a task with the interrupts disabled.
+		\param task The task index, as returned by RateScheduler::addTask().
+		\return The task statistics, or empty statistics for an invalid index.
+	*/
+	Stats stats(int8_t task) const; //get task statistics
+
+	/*! \brief Get task priority.
+		\details The function gets the NVIC priority assigned to a task by RateScheduler::begin(), e.g. to mask the task with ModelBinding::applyAtomic().
+		\param task The task index, as returned by RateScheduler::addTask().
+		\return The NVIC priority, or 0 for an invalid index or if not started.
+	*/
+	uint8_t priority(int8_t task) const; //get task priority
+
+	/*! \brief Reset statistics.
+		\details The function resets the statistics of all tasks.
+	*/
+	void resetStats(); //reset statistics
+
+	/*! \brief Get ticks.
+		\details The function gets the number of base ticks since RateScheduler::begin().
+		\return The number of base ticks.
+	*/
+	uint32_t ticks() const { return _ticks; } //get ticks
+
+	/*! \brief Convert cycles to us.
+		\details The function converts the CPU cycles of RateScheduler::Stats to us.
+		\param cycles The CPU cycles.
+		\return The time in us.
+	*/
+	static float cyclesToMicros(uint32_t cycles) { return cycles * (1e6f / F_CPU_ACTUAL); } //cycles to us
+
+private:
+	//task
+	struct Task {
+		TaskFunction fn = nullptr; //task function
+		uint32_t period = 0; //period in ticks
+		uint32_t countdown = 0; //ticks to next release
+		uint32_t release = 0; //cycle counter at last release
+		volatile boolean busy = false; //released and not completed
+		uint8_t irq = 0; //software interrupt
+		uint8_t priority = 0; //NVIC priority
+		Stats stats; //statistics
+	};
+
+	//vars
+	uint32_t _tick; //base tick in us
+	Task _tasks[MAX_TASKS]; //periodic tasks
+	uint8_t _numTasks = 0; //number of periodic tasks
+	TaskFunction _background[MAX_BACKGROUND]; //background tasks
+	uint8_t _numBackground = 0; //number of background tasks
+	volatile uint32_t _ticks = 0; //base ticks
+	volatile uint32_t _nested = 0; //net cycles of all completed runs, for the preemption time
+	boolean _started = false; //true when started
+	IntervalTimer _timer; //base tick timer
+
+	//static
+	static RateScheduler* _instance; //running scheduler
+	static const uint8_t IRQS[MAX_TASKS]; //software interrupts
+	static void tickIsr(); //base tick interrupt
+	template<uint8_t N> static void taskIsr() { _instance->execute(N); } //task interrupt
+
+	//functions
+	void tick(); //release tasks
+	void execute(uint8_t index); //run task
+};
+
+#endif
+
+#endif
@@ -69,7 +69,7 @@ uint8_t I2CTransfer::sendData(const uint16_t& messageLen, const uint8_t& packetI
 	port->beginTransmission(targetAddress);
 	port->write(packet.preamble, sizeof(packet.preamble));
 	port->write(packet.txBuff, numBytesIncl);
-	port->write(packet.postamble, sizeof(packet.postamble));
+	port->write(packet.postamble, packet.postambleLen);
 	port->endTransmission();
 
 	return numBytesIncl;
@@ -24,6 +24,7 @@ void Packet::begin(const configST& configs)
 	callbacks    = configs.callbacks;
 	callbacksLen = configs.callbacksLen;
 	timeout 	 = configs.timeout;
+	setCRC(configs.crcType);
 }
 
 
@@ -67,34 +68,42 @@ void Packet::begin(const bool& _debug, Stream& _debugPort, const uint32_t& _time
 */
 uint8_t Packet::constructPacket(const uint16_t& messageLen, const uint8_t& packetID)
 {
-	if (messageLen > MAX_PACKET_SIZE)
-	{
-		calcOverhead(txBuff, MAX_PACKET_SIZE);
-		stuffPacket(txBuff, MAX_PACKET_SIZE);
-		uint8_t crcVal = crc.calculate(txBuff, MAX_PACKET_SIZE);
+	return constructPacket(txBuff, messageLen, packetID);
+}
 
-		preamble[1] = packetID;
-		preamble[2] = overheadByte;
-		preamble[3] = MAX_PACKET_SIZE;
 
-		postamble[0] = crcVal;
+/*
+ uint8_t Packet::constructPacket(uint8_t arr[], const uint16_t& messageLen, const uint8_t& packetID)
+ Description:
+ ------------
+  * Calculate, format, and insert the packet protocol metadata for a payload
+  held in a buffer other than the packet transmit buffer (the payload is
+  stuffed in place)
+ Inputs:
+ -------
+  * uint8_t arr[] - Payload buffer of at least MAX_PACKET_SIZE bytes
+  * const uint16_t& messageLen - Number of values in arr[]
+  to send as the payload in the next packet
+  * const uint8_t& packetID - The packet 8-bit identifier
+ Return:
+ -------
+  * uint8_t - Number of payload bytes included in packet
+*/
+uint8_t Packet::constructPacket(uint8_t arr[], const uint16_t& messageLen, const uint8_t& packetID)
+{
+	uint8_t len = (messageLen > MAX_PACKET_SIZE) ? MAX_PACKET_SIZE : (uint8_t)messageLen;
 
-		return MAX_PACKET_SIZE;
-	}
-	else
-	{
-		calcOverhead(txBuff, (uint8_t)messageLen);
-		stuffPacket(txBuff, (uint8_t)messageLen);
-		uint8_t crcVal = crc.calculate(txBuff, (uint8_t)messageLen);
+	stuffPacket(arr, len);
+	uint32_t crcVal = packetCRC.calculate(arr, len);
 
-		preamble[1] = packetID;
-		preamble[2] = overheadByte;
-		preamble[3] = messageLen;
+	preamble[1] = packetID;
+	preamble[2] = overheadByte;
+	preamble[3] = len;
 
-		postamble[0] = crcVal;
+	for (uint8_t i = 0; i < packetCRC.size(); i++)
+		postamble[i] = (crcVal >> (8 * i)) & 0xFF; // least significant byte first
 
-		return (uint8_t)messageLen;
-	}
+	return len;
 }
 
 
@@ -118,7 +127,7 @@ uint8_t Packet::constructPacket(const uint16_t& messageLen, const uint8_t& packe
 
 uint8_t Packet::parse(const uint8_t& recChar, const bool& valid)
 {
-	bool packet_fresh = (packetStart == 0) || ((millis() - packetStart) < timeout);
+	bool packet_fresh = fresh();
 
 	if(!packet_fresh) //packet is stale, start over.
 	{
@@ -193,16 +202,25 @@ uint8_t Packet::parse(const uint8_t& recChar, const bool& valid)
 				payIndex++;
 
 				if (payIndex == bytesToRec)
+				{
 					state    = find_crc;
+					crcIndex = 0;
+					recCrc   = 0;
+				}
 			}
 			break;
 		}
 
 		case find_crc: ///////////////////////////////////////////
 		{
-			uint8_t calcCrc = crc.calculate(rxBuff, bytesToRec);
+			recCrc |= (uint32_t)recChar << (8 * crcIndex++);
+
+			if (crcIndex < packetCRC.size())
+				break;
 
-			if (calcCrc == recChar)
+			uint32_t calcCrc = packetCRC.calculate(rxBuff, bytesToRec);
+
+			if (calcCrc == recCrc)
 				state = find_end_byte;
 			else
 			{
@@ -230,7 +248,7 @@ uint8_t Packet::parse(const uint8_t& recChar, const bool& valid)
 				bytesRead = bytesToRec;
 				status    = NEW_DATA;
 
-				if (callbacks)
+				if (callbacks && !reservedID(idByte))
 				{
 					if (idByte < callbacksLen)
 						callbacks[idByte]();
@@ -283,6 +301,91 @@ uint8_t Packet::parse(const uint8_t& recChar, const bool& valid)
 }
 
 
+/*
+ uint16_t Packet::parse(const uint8_t arr[], const uint16_t& len)
+ Description:
+ ------------
+  * Parses a block of incoming serial data, as "parse()" called for
+  each byte, until a packet is complete or an error occurs. The start
+  byte is searched with memchr() and the payload is copied with a single
+  memcpy(), so that only the few header and trailer bytes are parsed one
+  at a time. The remaining bytes are parsed by the next call
+ Inputs:
+ -------
+  * const uint8_t arr[] - Block of chars to parse
+  * const uint16_t& len - Number of chars in arr[]
+ Return:
+ -------
+  * uint16_t - Number of chars of arr[] parsed (the result is in
+  "status" and "bytesRead")
+*/
+uint16_t Packet::parse(const uint8_t arr[], const uint16_t& len)
+{
+	uint16_t i = 0;
+
+	bytesRead = 0;
+	status    = CONTINUE;
+
+	while (i < len)
+	{
+		if (state == find_start_byte)
+		{
+			const uint8_t* start = (const uint8_t*)memchr(arr + i, START_BYTE, len - i);
+
+			if (start == NULL)
+				return len;
+
+			i = start - arr;
+		}
+		else if ((state == find_payload) && fresh())
+		{
+			uint16_t n = bytesToRec - payIndex;
+
+			if (n > (len - i))
+				n = len - i;
+
+			memcpy(rxBuff + payIndex, arr + i, n);
+			payIndex += n;
+			i += n;
+
+			if (payIndex == bytesToRec)
+			{
+				state    = find_crc;
+				crcIndex = 0;
+				recCrc   = 0;
+			}
+
+			continue;
+		}
+
+		parse(arr[i++]);
+
+		if (status != CONTINUE)
+			break;
+	}
+
+	return i;
+}
+
+
+/*
+ bool Packet::fresh()
+ Description:
+ ------------
+  * Checks the timeout of the packet being parsed
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not the packet being parsed is not stale
+*/
+bool Packet::fresh()
+{
+	return (packetStart == 0) || ((millis() - packetStart) < timeout);
+}
+
+
 /*
  uint8_t Packet::currentPacketID()
  Description:
@@ -302,59 +405,64 @@ uint8_t Packet::currentPacketID()
 
 
 /*
- void Packet::calcOverhead(uint8_t arr[], const uint8_t &len)
+ uint8_t Packet::deliver(const uint8_t arr[], const uint8_t &len, const uint8_t &packetID)
  Description:
  ------------
-  * Calculates the COBS (Consistent Overhead Stuffing) Overhead
-  byte and stores it in the class's overheadByte variable. This
-  variable holds the byte position (within the payload) of the
-  first payload byte equal to that of START_BYTE
+  * Loads a payload received by an upper layer protocol (i.e. inside
+  another packet) into the receive buffer (rxBuff) as a new packet
+  with the given ID, and calls the callback of that ID
  Inputs:
  -------
-  * uint8_t arr[] - Array of values the overhead is to be calculated
-  over
-  * const uint8_t &len - Number of elements in arr[]
+  * const uint8_t arr[] - Payload
+  * const uint8_t &len - Number of bytes in arr[]
+  * const uint8_t &packetID - The packet 8-bit identifier
  Return:
  -------
-  * void
+  * uint8_t bytesRead - Num bytes in RX buffer
 */
-void Packet::calcOverhead(uint8_t arr[], const uint8_t& len)
+uint8_t Packet::deliver(const uint8_t arr[], const uint8_t& len, const uint8_t& packetID)
 {
-	overheadByte = 0xFF;
+	memmove(rxBuff, arr, len);
+	idByte    = packetID;
+	bytesRead = len;
+	status    = NEW_DATA;
 
-	for (uint8_t i = 0; i < len; i++)
+	if (callbacks && !reservedID(idByte))
 	{
-		if (arr[i] == START_BYTE)
+		if (idByte < callbacksLen)
+			callbacks[idByte]();
+		else if (debug)
 		{
-			overheadByte = i;
-			break;
+			debugPort->print(F("ERROR: No callback available for packet ID "));
+			debugPort->println(idByte);
 		}
 	}
+
+	return bytesRead;
 }
 
 
 /*
- int16_t Packet::findLast(uint8_t arr[], const uint8_t &len)
+ bool Packet::hasStartByte(const uint8_t arr[])
  Description:
  ------------
-  * Finds last instance of the value START_BYTE within the given
-  packet array
+  * Checks 4 bytes at once for the value START_BYTE, with the
+  word-wide zero byte test on the bytes xor-ed with START_BYTE
  Inputs:
  -------
-  * uint8_t arr[] - Packet array
-  * const uint8_t &len - Number of elements in arr[]
+  * const uint8_t arr[] - 4 bytes to check
  Return:
  -------
-  * int16_t - Index of last instance of the value START_BYTE within the given
-  packet array
+  * bool - Whether or not one of the 4 bytes is equal to START_BYTE
 */
-int16_t Packet::findLast(uint8_t arr[], const uint8_t& len)
+bool Packet::hasStartByte(const uint8_t arr[])
 {
-	for (uint8_t i = (len - 1); i != 0xFF; i--)
-		if (arr[i] == START_BYTE)
-			return i;
+	uint32_t word;
 
-	return -1;
+	memcpy(&word, arr, sizeof(word));
+	word ^= START_BYTE * 0x01010101UL;
+
+	return ((word - 0x01010101UL) & ~word & 0x80808080UL) != 0;
 }
 
 
@@ -363,7 +471,11 @@ int16_t Packet::findLast(uint8_t arr[], const uint8_t& len)
  Description:
  ------------
   * Enforces the COBS (Consistent Overhead Stuffing) ruleset across
-  all bytes in the packet against the value of START_BYTE
+  all bytes in the packet against the value of START_BYTE, in a single
+  forward pass that skips 4 bytes at a time when none of them is
+  START_BYTE. The overhead byte (position of the first START_BYTE, 0xFF
+  if none) is stored in the class's overheadByte variable, and each
+  START_BYTE is replaced by the distance to the next one (0 for the last)
  Inputs:
  -------
   * uint8_t arr[] - Array of values to stuff
@@ -374,19 +486,34 @@ int16_t Packet::findLast(uint8_t arr[], const uint8_t& len)
 */
 void Packet::stuffPacket(uint8_t arr[], const uint8_t& len)
 {
-	int16_t refByte = findLast(arr, len);
+	int16_t refByte = -1;
+	uint8_t i       = 0;
 
-	if (refByte != -1)
+	overheadByte = 0xFF;
+
+	while (i < len)
 	{
-		for (uint8_t i = (len - 1); i != 0xFF; i--)
+		if (((len - i) >= 4) && !hasStartByte(arr + i))
 		{
-			if (arr[i] == START_BYTE)
-			{
-				arr[i]  = refByte - i;
-				refByte = i;
-			}
+			i += 4;
+			continue;
 		}
+
+		if (arr[i] == START_BYTE)
+		{
+			if (refByte == -1)
+				overheadByte = i;
+			else
+				arr[refByte] = i - refByte;
+
+			refByte = i;
+		}
+
+		i++;
 	}
+
+	if (refByte != -1)
+		arr[refByte] = 0;
 }
 
 
@@ -408,9 +535,9 @@ void Packet::unpackPacket(uint8_t arr[])
 	uint8_t testIndex = recOverheadByte;
 	uint8_t delta     = 0;
 
-	if (testIndex <= MAX_PACKET_SIZE)
+	if (testIndex < bytesToRec)
 	{
-		while (arr[testIndex])
+		while (arr[testIndex] && ((testIndex + arr[testIndex]) < bytesToRec))
 		{
 			delta          = arr[testIndex];
 			arr[testIndex] = START_BYTE;
@@ -421,6 +548,40 @@ void Packet::unpackPacket(uint8_t arr[])
 }
 
 
+/*
+ bool Packet::setCRC(const uint8_t& crcType)
+ Description:
+ ------------
+  * Selects the CRC appended to the payload, sent least significant
+  byte first. Both ends must use the same CRC. An unknown type is
+  rejected and the previous CRC is kept
+ Inputs:
+ -------
+  * const uint8_t& crcType - CRC_8 (default), CRC_16 or CRC_32
+ Return:
+ -------
+  * bool - Whether or not the CRC type is known
+*/
+bool Packet::setCRC(const uint8_t& crcType)
+{
+	if (!PacketCRC::valid(crcType))
+	{
+		if (debug)
+			debugPort->println("ERROR: UNKNOWN CRC TYPE");
+
+		return false;
+	}
+
+	packetCRC    = PacketCRC(crcType);
+	postambleLen = packetCRC.size() + 1;
+
+	postamble[postambleLen - 1] = STOP_BYTE;
+	state = find_start_byte;
+
+	return true;
+}
+
+
 /*
  void Packet::reset()
  Description:
@@ -443,3 +604,41 @@ void Packet::reset()
 	status      = CONTINUE;
 	packetStart = 0;
 }
+
+
+/*
+ void Packet::reserveIDs(const uint8_t& firstID)
+ Description:
+ ------------
+  * Reserves the packet IDs from "firstID" to 0xFF for an upper layer
+  protocol (e.g. the streams of SerialTransfer), which consumes those
+  packets itself: no callback is called and no error is printed for them
+ Inputs:
+ -------
+  * const uint8_t& firstID - First reserved packet ID
+ Return:
+ -------
+  * void
+*/
+void Packet::reserveIDs(const uint8_t& firstID)
+{
+	firstReserved = firstID;
+}
+
+
+/*
+ bool Packet::reservedID(const uint8_t& packetID)
+ Description:
+ ------------
+  * Checks whether or not a packet ID is reserved for an upper layer protocol
+ Inputs:
+ -------
+  * const uint8_t& packetID - The packet 8-bit identifier
+ Return:
+ -------
+  * bool - Whether or not the packet ID is reserved
+*/
+bool Packet::reservedID(const uint8_t& packetID)
+{
+	return packetID >= firstReserved;
+}
@@ -1,7 +1,7 @@
 /*
 01111110 00000000 11111111 00000000 00000000 00000000 ... 00000000 10000001
 |      | |      | |      | |      | |      | |      | | | |      | |______|__Stop byte
-|      | |      | |      | |      | |      | |      | | | |______|___________8-bit CRC
+|      | |      | |      | |      | |      | |      | | | |______|___________8-bit CRC (16/32-bit with setCRC())
 |      | |      | |      | |      | |      | |      | |_|____________________Rest of payload
 |      | |      | |      | |      | |      | |______|________________________2nd payload byte
 |      | |      | |      | |      | |______|_________________________________1st payload byte
@@ -30,9 +30,10 @@ const int8_t STALE_PACKET_ERROR = -3;
 const uint8_t START_BYTE = 0x7E;
 const uint8_t STOP_BYTE  = 0x81;
 
-const uint8_t PREAMBLE_SIZE   = 4;
-const uint8_t POSTAMBLE_SIZE  = 2;
-const uint8_t MAX_PACKET_SIZE = 0xFE; // Maximum allowed payload bytes per packet
+const uint8_t PREAMBLE_SIZE      = 4;
+const uint8_t POSTAMBLE_SIZE     = 2;
+const uint8_t MAX_POSTAMBLE_SIZE = CRC_32 + 1; // 32-bit CRC and stop byte
+const uint8_t MAX_PACKET_SIZE    = 0xFE;       // Maximum allowed payload bytes per packet
 
 const uint8_t DEFAULT_TIMEOUT = 50;
 
@@ -44,6 +45,7 @@ struct configST
 	const functionPtr* callbacks    = NULL;
 	uint8_t            callbacksLen = 0;
 	uint32_t           timeout      = __UINT32_MAX__;
+	uint8_t            crcType      = CRC_8;
 };
 
 
@@ -52,8 +54,9 @@ class Packet
   public: // <<---------------------------------------//public
 	uint8_t txBuff[MAX_PACKET_SIZE];
 	uint8_t rxBuff[MAX_PACKET_SIZE];
-	uint8_t preamble[PREAMBLE_SIZE]   = {START_BYTE, 0, 0, 0};
-	uint8_t postamble[POSTAMBLE_SIZE] = {0, STOP_BYTE};
+	uint8_t preamble[PREAMBLE_SIZE]       = {START_BYTE, 0, 0, 0};
+	uint8_t postamble[MAX_POSTAMBLE_SIZE] = {0, STOP_BYTE};
+	uint8_t postambleLen                  = POSTAMBLE_SIZE;
 
 	uint8_t bytesRead = 0;
 	int8_t  status    = 0;
@@ -62,9 +65,15 @@ class Packet
 	void    begin(const configST& configs);
 	void    begin(const bool& _debug = true, Stream& _debugPort = Serial, const uint32_t& _timeout = DEFAULT_TIMEOUT);
 	uint8_t constructPacket(const uint16_t& messageLen, const uint8_t& packetID = 0);
+	uint8_t constructPacket(uint8_t arr[], const uint16_t& messageLen, const uint8_t& packetID = 0);
 	uint8_t parse(const uint8_t& recChar, const bool& valid = true);
+	uint16_t parse(const uint8_t arr[], const uint16_t& len);
 	uint8_t currentPacketID();
+	uint8_t deliver(const uint8_t arr[], const uint8_t& len, const uint8_t& packetID);
 	void    reset();
+	bool    setCRC(const uint8_t& crcType);
+	void    reserveIDs(const uint8_t& firstID);
+	bool    reservedID(const uint8_t& packetID);
 
 
 	/*
@@ -164,8 +173,9 @@ class Packet
 	};
 	fsm state = find_start_byte;
 
-	const functionPtr* callbacks    = NULL;
-	uint8_t            callbacksLen = 0;
+	const functionPtr* callbacks     = NULL;
+	uint8_t            callbacksLen  = 0;
+	uint16_t           firstReserved = 0x100; // IDs from here up are consumed by an upper layer protocol, none by default
 
 	Stream* debugPort;
 	bool    debug = false;
@@ -179,9 +189,13 @@ class Packet
 	uint32_t packetStart    = 0;
 	uint32_t timeout;
 
+	PacketCRC packetCRC;
+	uint8_t   crcIndex = 0;
+	uint32_t  recCrc   = 0;
+
 
-	void    calcOverhead(uint8_t arr[], const uint8_t& len);
-	int16_t findLast(uint8_t arr[], const uint8_t& len);
+	bool    fresh();
+	bool    hasStartByte(const uint8_t arr[]);
 	void    stuffPacket(uint8_t arr[], const uint8_t& len);
 	void    unpackPacket(uint8_t arr[]);
 };
@@ -0,0 +1,118 @@
+#include "PacketCRC.h"
+
+
+constexpr PacketCRCTables crcTables PACKETCRC_FLASH = PacketCRCTables();
+
+
+/*
+ uint8_t PacketCRC::crc8(const uint8_t arr[], uint16_t len, uint8_t crc)
+ Description:
+ ------------
+  * Calculates the CRC-8 (polynomial 0x9B) of a buffer, CRC_SLICES bytes
+  per step with the slice-by-N tables
+ Inputs:
+ -------
+  * const uint8_t arr[] - Buffer
+  * uint16_t len - Number of bytes in arr[]
+  * uint8_t crc - CRC of the preceding bytes, to continue it (0 to start)
+ Return:
+ -------
+  * uint8_t - CRC-8
+*/
+uint8_t PacketCRC::crc8(const uint8_t arr[], uint16_t len, uint8_t crc)
+{
+	const uint8_t (*t)[256] = crcTables.crc8;
+
+	for (; len >= CRC_SLICES; len -= CRC_SLICES, arr += CRC_SLICES)
+	{
+#if (PACKETCRC_SLICES == 8)
+		crc = t[7][crc ^ arr[0]] ^ t[6][arr[1]] ^ t[5][arr[2]] ^ t[4][arr[3]] ^
+		      t[3][arr[4]] ^ t[2][arr[5]] ^ t[1][arr[6]] ^ t[0][arr[7]];
+#else
+		crc = t[3][crc ^ arr[0]] ^ t[2][arr[1]] ^ t[1][arr[2]] ^ t[0][arr[3]];
+#endif
+	}
+
+	while (len--)
+		crc = t[0][crc ^ *arr++];
+
+	return crc;
+}
+
+
+/*
+ uint16_t PacketCRC::crc16(const uint8_t arr[], uint16_t len, uint16_t crc)
+ Description:
+ ------------
+  * Calculates the CRC-16/CCITT-FALSE of a buffer, CRC_SLICES bytes per
+  step with the slice-by-N tables
+ Inputs:
+ -------
+  * const uint8_t arr[] - Buffer
+  * uint16_t len - Number of bytes in arr[]
+  * uint16_t crc - CRC of the preceding bytes, to continue it (0xFFFF
+  to start)
+ Return:
+ -------
+  * uint16_t - CRC-16
+*/
+uint16_t PacketCRC::crc16(const uint8_t arr[], uint16_t len, uint16_t crc)
+{
+	const uint16_t (*t)[256] = crcTables.crc16;
+
+	for (; len >= CRC_SLICES; len -= CRC_SLICES, arr += CRC_SLICES)
+	{
+#if (PACKETCRC_SLICES == 8)
+		crc = t[7][(crc >> 8) ^ arr[0]] ^ t[6][(crc & 0xFF) ^ arr[1]] ^ t[5][arr[2]] ^ t[4][arr[3]] ^
+		      t[3][arr[4]] ^ t[2][arr[5]] ^ t[1][arr[6]] ^ t[0][arr[7]];
+#else
+		crc = t[3][(crc >> 8) ^ arr[0]] ^ t[2][(crc & 0xFF) ^ arr[1]] ^ t[1][arr[2]] ^ t[0][arr[3]];
+#endif
+	}
+
+	while (len--)
+		crc = (crc << 8) ^ t[0][(crc >> 8) ^ *arr++];
+
+	return crc;
+}
+
+
+/*
+ uint32_t PacketCRC::crc32(const uint8_t arr[], uint16_t len, uint32_t crc)
+ Description:
+ ------------
+  * Calculates the CRC-32 (as zlib) of a buffer, CRC_SLICES bytes per
+  step with the slice-by-N tables
+ Inputs:
+ -------
+  * const uint8_t arr[] - Buffer
+  * uint16_t len - Number of bytes in arr[]
+  * uint32_t crc - CRC of the preceding bytes, to continue it (0 to
+  start, as the crc32() of zlib)
+ Return:
+ -------
+  * uint32_t - CRC-32
+*/
+uint32_t PacketCRC::crc32(const uint8_t arr[], uint16_t len, uint32_t crc)
+{
+	const uint32_t (*t)[256] = crcTables.crc32;
+
+	crc = ~crc;
+
+	for (; len >= CRC_SLICES; len -= CRC_SLICES, arr += CRC_SLICES)
+	{
+		uint32_t lo = crc ^ (arr[0] | (arr[1] << 8) | (arr[2] << 16) | ((uint32_t)arr[3] << 24));
+
+#if (PACKETCRC_SLICES == 8)
+		crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+		      t[3][arr[4]] ^ t[2][arr[5]] ^ t[1][arr[6]] ^ t[0][arr[7]];
+#else
+		crc = t[3][lo & 0xFF] ^ t[2][(lo >> 8) & 0xFF] ^ t[1][(lo >> 16) & 0xFF] ^ t[0][lo >> 24];
+#endif
+	}
+
+	while (len--)
+		crc = (crc >> 8) ^ t[0][(crc ^ *arr++) & 0xFF];
+
+	return ~crc;
+}
@@ -2,74 +2,131 @@
 #include "Arduino.h"
 
 
-class PacketCRC
+const uint8_t CRC_8  = 1; // CRC-8, polynomial 0x9B (default, 1 byte)
+const uint8_t CRC_16 = 2; // CRC-16/CCITT-FALSE, polynomial 0x1021, initial value 0xFFFF (2 bytes)
+const uint8_t CRC_32 = 4; // CRC-32 as zlib, reflected polynomial 0xEDB88320 (4 bytes)
+
+const uint8_t CRC8_POLY  = 0x9B;
+const uint16_t CRC16_POLY = 0x1021;
+const uint32_t CRC32_POLY = 0xEDB88320;
+
+#if !defined(PACKETCRC_SLICES)
+#if defined(__IMXRT1062__)
+#define PACKETCRC_SLICES 4 // slice-by-4 on Teensy 4: 7 KB of tables in the tightly-coupled RAM instead of 14 KB
+#else
+#define PACKETCRC_SLICES 8
+#endif
+#endif
+
+#if (PACKETCRC_SLICES != 4) && (PACKETCRC_SLICES != 8)
+#error "PACKETCRC_SLICES must be 4 or 8"
+#endif
+
+#if !defined(PACKETCRC_FLASH)
+#define PACKETCRC_FLASH // tables in RAM (DTCM on Teensy 4), -DPACKETCRC_FLASH=PROGMEM keeps them in flash
+#endif
+
+const uint8_t CRC_SLICES = PACKETCRC_SLICES; // Bytes processed per step of the slice-by-N kernels
+
+
+/*
+ struct PacketCRCTables
+ Description:
+ ------------
+  * Lookup tables of the slice-by-N kernels (N = CRC_SLICES), generated
+  at compile time. Table k gives the CRC of a byte followed by k zero
+  bytes, so that N bytes are processed with N independent lookups. The
+  tables of CRC-16 and CRC-32 are shared with HostPort
+*/
+struct PacketCRCTables
 {
-  public: // <<---------------------------------------//public
-	uint8_t poly = 0;
-
-
-	PacketCRC(const uint8_t& polynomial = 0x9B, const uint8_t& crcLen = 8)
-	{
-		poly      = polynomial;
-		crcLen_   = crcLen;
-		tableLen_ = pow(2, crcLen);
-		csTable   = new uint8_t[tableLen_];
-
-		generateTable();
-	}
+	uint8_t  crc8[CRC_SLICES][256];
+	uint16_t crc16[CRC_SLICES][256];
+	uint32_t crc32[CRC_SLICES][256];
 
-	void generateTable()
+	constexpr PacketCRCTables() : crc8(), crc16(), crc32()
 	{
-		for (uint16_t i = 0; i < tableLen_; ++i)
+		for (uint16_t i = 0; i < 256; i++)
 		{
-			int curr = i;
+			uint8_t  c8  = i;
+			uint16_t c16 = i << 8;
+			uint32_t c32 = i;
 
-			for (int j = 0; j < 8; ++j)
+			for (uint8_t j = 0; j < 8; j++)
 			{
-				if ((curr & 0x80) != 0)
-					curr = (curr << 1) ^ (int)poly;
-				else
-					curr <<= 1;
+				c8  = (c8 & 0x80) ? ((c8 << 1) ^ CRC8_POLY) : (c8 << 1);
+				c16 = (c16 & 0x8000) ? ((c16 << 1) ^ CRC16_POLY) : (c16 << 1);
+				c32 = (c32 & 1) ? ((c32 >> 1) ^ CRC32_POLY) : (c32 >> 1);
 			}
 
-			csTable[i] = (byte)curr;
+			crc8[0][i]  = c8;
+			crc16[0][i] = c16;
+			crc32[0][i] = c32;
+		}
+
+		for (uint8_t k = 1; k < CRC_SLICES; k++)
+		{
+			for (uint16_t i = 0; i < 256; i++)
+			{
+				crc8[k][i]  = crc8[0][crc8[k - 1][i]];
+				crc16[k][i] = (crc16[k - 1][i] << 8) ^ crc16[0][crc16[k - 1][i] >> 8];
+				crc32[k][i] = (crc32[k - 1][i] >> 8) ^ crc32[0][crc32[k - 1][i] & 0xFF];
+			}
 		}
 	}
+};
+
+
+extern const PacketCRCTables crcTables;
+
+
+class PacketCRC
+{
+  public: // <<---------------------------------------//public
+	constexpr PacketCRC(const uint8_t& crcType = CRC_8) : type_(valid(crcType) ? crcType : 0)
+	{
+	}
 
-	void printTable()
+	PacketCRC(const uint8_t& polynomial, const uint8_t& crcLen) = delete; // the polynomial is fixed by the CRC type
+
+	static constexpr bool valid(const uint8_t& crcType)
 	{
-		for (uint16_t i = 0; i < tableLen_; i++)
-		{
-			Serial.print(csTable[i], HEX);
+		return (crcType == CRC_8) || (crcType == CRC_16) || (crcType == CRC_32);
+	}
 
-			if ((i + 1) % 16)
-				Serial.print(' ');
-			else
-				Serial.println();
-		}
+	bool valid() const
+	{
+		return type_ != 0;
 	}
 
-	uint8_t calculate(const uint8_t& val)
+	uint8_t size() const
 	{
-		if (val < tableLen_)
-			return csTable[val];
-		return 0;
+		return type_;
 	}
 
-	uint8_t calculate(uint8_t arr[], uint8_t len)
+	uint8_t calculate(const uint8_t& val) const
 	{
-		uint8_t crc = 0;
-		for (uint16_t i = 0; i < len; i++)
-			crc = csTable[crc ^ arr[i]];
+		return crcTables.crc8[0][val];
+	}
 
-		return crc;
+	uint32_t calculate(const uint8_t arr[], const uint16_t& len) const
+	{
+		if (type_ == CRC_16)
+			return crc16(arr, len);
+		if (type_ == CRC_32)
+			return crc32(arr, len);
+		if (type_ == CRC_8)
+			return crc8(arr, len);
+		return 0;
 	}
 
+	static uint8_t  crc8(const uint8_t arr[], uint16_t len, uint8_t crc = 0);
+	static uint16_t crc16(const uint8_t arr[], uint16_t len, uint16_t crc = 0xFFFF);
+	static uint32_t crc32(const uint8_t arr[], uint16_t len, uint32_t crc = 0);
+
 
   private: // <<---------------------------------------//private
-	uint16_t tableLen_;
-	uint8_t  crcLen_;
-	uint8_t* csTable;
+	uint8_t type_; // CRC_8, CRC_16 or CRC_32, 0 if the type given is unknown
 };
 
 
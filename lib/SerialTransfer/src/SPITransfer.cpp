@@ -1,61 +1,76 @@
-#include "Arduino.h"
-/* UNCOMMENT FOR USAGE
-#if not(defined(MBED_H) || defined(__SAM3X8E__) || defined(DISABLE_SPI_SERIALTRANSFER)) // These boards are/will not be supported by SPITransfer.h
-
 #include "SPITransfer.h"
 
-*/
+#if defined(SPI_HAS_TRANSFER_ASYNC)
+
+
 /*
- void SPITransfer::begin(SPIClass &_port, configST configs, const uint8_t &_SS)
+ void SPITransfer::begin(SPIClass &_port, configST configs, const uint8_t &_SS, const SPISettings &_settings)
  Description:
  ------------
-  * Advanced initializer for the SPITransfer Class
+  * Advanced initializer for the SPITransfer Class (SPI master)
  Inputs:
  -------
   * const SPIClass &_port - SPI port to communicate over
   * const configST configs - Struct that holds config
-  * const uint8_t &_SS - SPI buslave select pin used
   values for all possible initialization parameters
+  * const uint8_t &_SS - SPI slave select pin used
+  * const SPISettings &_settings - Clock, bit order and mode of the transfers
  Return:
  -------
   * void
-*//*
-void SPITransfer::begin(SPIClass& _port, const configST configs, const uint8_t& _SS)
+*/
+void SPITransfer::begin(SPIClass& _port, const configST configs, const uint8_t& _SS, const SPISettings& _settings)
 {
-	port = &_port;
+	port     = &_port;
+	ssPin    = _SS;
+	settings = _settings;
 	packet.begin(configs);
-	ssPin = _SS;
+
+	pinMode(ssPin, OUTPUT);
+	digitalWrite(ssPin, HIGH);
+	event.setContext(this);
+	event.attachImmediate(transferDone);
 }
 
-*/
+
 /*
- void SPITransfer::begin(SPIClass &_port, const uint8_t &_SS, const bool _debug, Stream &_debugPort)
+ void SPITransfer::begin(SPIClass &_port, const uint8_t &_SS, const bool _debug, Stream &_debugPort, const SPISettings &_settings)
  Description:
  ------------
-  * Simple initializer for the SPITransfer Class
+  * Simple initializer for the SPITransfer Class (SPI master)
  Inputs:
  -------
-  * const Stream &_port - SPI port to communicate over
-  * const uint8_t &_SS - SPI buslave select pin used
+  * const SPIClass &_port - SPI port to communicate over
+  * const uint8_t &_SS - SPI slave select pin used
   * const bool _debug - Whether or not to print error messages
   * const Stream &_debugPort - Serial port to print error messages
+  * const SPISettings &_settings - Clock, bit order and mode of the transfers
  Return:
  -------
   * void
-*//*
-void SPITransfer::begin(SPIClass& _port, const uint8_t& _SS, const bool _debug, Stream& _debugPort)
+*/
+void SPITransfer::begin(SPIClass& _port, const uint8_t& _SS, const bool _debug, Stream& _debugPort, const SPISettings& _settings)
 {
-	port = &_port;
+	port     = &_port;
+	ssPin    = _SS;
+	settings = _settings;
 	packet.begin(_debug, _debugPort);
-	ssPin = _SS;
+
+	pinMode(ssPin, OUTPUT);
+	digitalWrite(ssPin, HIGH);
+	event.setContext(this);
+	event.attachImmediate(transferDone);
 }
 
-*/
+
 /*
  uint8_t SPITransfer::sendData(const uint16_t &messageLen, const uint8_t packetID)
  Description:
  ------------
-  * Send a specified number of bytes in packetized form
+  * Send a specified number of bytes in packetized form, waiting
+  for the end of the transfer. The whole packet is moved in a single
+  buffer transfer, and the bytes received meanwhile are parsed by
+  "available()"
  Inputs:
  -------
   * const uint16_t &messageLen - Number of values in txBuff
@@ -64,58 +79,126 @@ void SPITransfer::begin(SPIClass& _port, const uint8_t& _SS, const bool _debug,
  Return:
  -------
   * uint8_t numBytesIncl - Number of payload bytes included in packet
-*//*
+  (0 if an asynchronous transfer is still in progress)
+*/
 uint8_t SPITransfer::sendData(const uint16_t& messageLen, const uint8_t packetID)
 {
-	uint8_t numBytesIncl = packet.constructPacket(messageLen, packetID);
+	if (txBusy)
+		return 0;
 
-	digitalWrite(SS, LOW); // Enable SS (active low)
-	for (uint8_t i = 0; i < sizeof(packet.preamble); i++)
-	{
-		delay(1); // This delay is needed
-		port->transfer(packet.preamble[i]);
-	}
+	uint16_t len = buildFrame(messageLen, packetID);
+
+	port->beginTransaction(settings);
+	digitalWrite(ssPin, LOW); // Enable SS (active low)
+	port->transfer(txFrame, rxFrame, len);
+	digitalWrite(ssPin, HIGH); // Disable SS (active low)
+	port->endTransaction();
+
+	rxPos = 0;
+	rxLen = len;
+
+	return len - PREAMBLE_SIZE - packet.postambleLen;
+}
 
-	for (uint8_t i = 0; i < numBytesIncl; i++)
-	{
-		delay(1); // This delay is needed
-		port->transfer(packet.txBuff[i]);
-	}
 
-	for (uint8_t i = 0; i < sizeof(packet.postamble); i++)
+/*
+ bool SPITransfer::sendDataAsync(const uint16_t &messageLen, const uint8_t packetID, functionPtr callback)
+ Description:
+ ------------
+  * Queues a packet to the DMA engine of the SPI port and returns
+  immediately. The slave select is released and "callback" is called
+  from the DMA interrupt when the transfer is complete, so the callback
+  must be short. The SPI port must not be used by others until then
+ Inputs:
+ -------
+  * const uint16_t &messageLen - Number of values in txBuff
+  to send as the payload in the next packet
+  * const uint8_t packetID - The packet 8-bit identifier
+  * functionPtr callback - Function called at the end of the transfer
+  (NULL for none)
+ Return:
+ -------
+  * bool - Whether or not the transfer was started (false if the previous
+  one is still in progress)
+*/
+bool SPITransfer::sendDataAsync(const uint16_t& messageLen, const uint8_t packetID, functionPtr callback)
+{
+	if (txBusy)
+		return false;
+
+	frameLen     = buildFrame(messageLen, packetID);
+	doneCallback = callback;
+	txBusy       = true;
+
+	port->beginTransaction(settings);
+	digitalWrite(ssPin, LOW); // Enable SS (active low)
+
+	if (!port->transfer(txFrame, rxFrame, frameLen, event))
 	{
-		delay(1); // This delay is needed
-		port->transfer(packet.postamble[i]);
+		digitalWrite(ssPin, HIGH);
+		port->endTransaction();
+		txBusy = false;
+		return false;
 	}
-	digitalWrite(SS, HIGH); // Disable SS (active low)
 
-	return numBytesIncl;
+	return true;
 }
 
+
+/*
+ bool SPITransfer::busy()
+ Description:
+ ------------
+  * Returns whether or not an asynchronous transfer is in progress
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not an asynchronous transfer is in progress
 */
+bool SPITransfer::busy()
+{
+	return txBusy;
+}
+
+
 /*
  uint8_t SPITransfer::available()
  Description:
  ------------
-  * Parses incoming serial data, analyzes packet contents,
-  and reports errors/successful packet reception
+  * Parses the bytes received from the slave during the latest transfer,
+  analyzes packet contents, and reports errors/successful packet reception
  Inputs:
  -------
   * void
  Return:
  -------
   * uint8_t bytesRead - Num bytes in RX buffer
-*//*
+*/
 uint8_t SPITransfer::available()
 {
-	volatile uint8_t recChar = SPDR;
-	bytesRead                = packet.parse(recChar);
-	status                   = packet.status;
+	bytesRead = 0;
+	status    = NO_DATA;
+
+	if (txBusy)
+		return bytesRead;
+
+	while (rxPos < rxLen)
+	{
+		rxPos += packet.parse(rxFrame + rxPos, rxLen - rxPos);
+
+		bytesRead = packet.bytesRead;
+		status    = packet.status;
+
+		if (status != CONTINUE)
+			break;
+	}
 
 	return bytesRead;
 }
 
-*/
+
 /*
  uint8_t SPITransfer::currentPacketID()
  Description:
@@ -127,11 +210,65 @@ uint8_t SPITransfer::available()
  Return:
  -------
   * uint8_t - ID of the last parsed packet
-*//*
+*/
 uint8_t SPITransfer::currentPacketID()
 {
 	return packet.currentPacketID();
 }
 
-#endif // not (defined(MBED_H) || defined(__SAM3X8E__))
+
+/*
+ uint16_t SPITransfer::buildFrame(const uint16_t &messageLen, const uint8_t &packetID)
+ Description:
+ ------------
+  * Constructs the packet and copies preamble, payload and postamble
+  in the contiguous transmit frame
+ Inputs:
+ -------
+  * const uint16_t &messageLen - Number of values in txBuff
+  * const uint8_t &packetID - The packet 8-bit identifier
+ Return:
+ -------
+  * uint16_t - Number of bytes of the frame
+*/
+uint16_t SPITransfer::buildFrame(const uint16_t& messageLen, const uint8_t& packetID)
+{
+	uint8_t numBytesIncl = packet.constructPacket(messageLen, packetID);
+
+	memcpy(txFrame, packet.preamble, PREAMBLE_SIZE);
+	memcpy(txFrame + PREAMBLE_SIZE, packet.txBuff, numBytesIncl);
+	memcpy(txFrame + PREAMBLE_SIZE + numBytesIncl, packet.postamble, packet.postambleLen);
+
+	return PREAMBLE_SIZE + numBytesIncl + packet.postambleLen;
+}
+
+
+/*
+ void SPITransfer::transferDone(EventResponderRef _event)
+ Description:
+ ------------
+  * End of an asynchronous transfer, called from the DMA interrupt
+ Inputs:
+ -------
+  * EventResponderRef _event - Event of the transfer, whose context is
+  the SPITransfer object
+ Return:
+ -------
+  * void
 */
+void SPITransfer::transferDone(EventResponderRef _event)
+{
+	SPITransfer* self = (SPITransfer*)_event.getContext();
+
+	digitalWrite(self->ssPin, HIGH); // Disable SS (active low)
+	self->port->endTransaction();
+
+	self->rxPos  = 0;
+	self->rxLen  = self->frameLen;
+	self->txBusy = false;
+
+	if (self->doneCallback)
+		self->doneCallback();
+}
+
+#endif // defined(SPI_HAS_TRANSFER_ASYNC)
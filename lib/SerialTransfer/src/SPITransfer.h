@@ -1,11 +1,14 @@
 #pragma once
-/* UNCOMMENT FOR USAGE
 #include "Arduino.h"
+#include "SPI.h"
 
-#if not(defined(MBED_H) || defined(__SAM3X8E__)) // These boards are/will not be supported by SPITransfer.h
+#if defined(SPI_HAS_TRANSFER_ASYNC) // Boards whose SPI library moves buffers with DMA and an EventResponder (Teensy)
 
 #include "Packet.h"
-#include "SPI.h"
+
+
+const uint16_t SPI_FRAME_SIZE = PREAMBLE_SIZE + MAX_PACKET_SIZE + MAX_POSTAMBLE_SIZE; // Maximum bytes of a packet on the wire
+const uint16_t SPI_FRAME_BUFF_SIZE = (SPI_FRAME_SIZE + 31) / 32 * 32; // Frame buffers in whole 32-byte cache lines, flushed and deleted by the SPI DMA
 
 
 class SPITransfer
@@ -16,13 +19,15 @@ class SPITransfer
 	int8_t  status    = 0;
 
 
-	void    begin(SPIClass& _port, const configST configs, const uint8_t& _SS = SS);
-	void    begin(SPIClass& _port, const uint8_t& _SS = SS, const bool _debug = true, Stream& _debugPort = Serial);
+	void    begin(SPIClass& _port, const configST configs, const uint8_t& _SS = SS, const SPISettings& _settings = SPISettings(4000000, MSBFIRST, SPI_MODE0));
+	void    begin(SPIClass& _port, const uint8_t& _SS = SS, const bool _debug = true, Stream& _debugPort = Serial, const SPISettings& _settings = SPISettings(4000000, MSBFIRST, SPI_MODE0));
 	uint8_t sendData(const uint16_t& messageLen, const uint8_t packetID = 0);
+	bool    sendDataAsync(const uint16_t& messageLen, const uint8_t packetID = 0, functionPtr callback = NULL);
+	bool    busy();
 	uint8_t available();
 	uint8_t currentPacketID();
 
-*/
+
 	/*
 	 uint16_t SPITransfer::txObj(const T &val, const uint16_t &index=0, const uint16_t &len=sizeof(T))
 	 Description:
@@ -41,14 +46,14 @@ class SPITransfer
 	 -------
 	  * uint16_t maxIndex - uint16_t maxIndex - Index of the transmit buffer (txBuff) that directly follows the bytes processed
 	  by the calling of this member function
-	*//*
+	*/
 	template <typename T>
 	uint16_t txObj(const T& val, const uint16_t& index = 0, const uint16_t& len = sizeof(T))
 	{
 		return packet.txObj(val, index, len);
 	}
 
-*/
+
 	/*
 	 uint16_t SPITransfer::rxObj(const T &val, const uint16_t &index=0, const uint16_t &len=sizeof(T))
 	 Description:
@@ -67,14 +72,14 @@ class SPITransfer
 	 -------
 	  * uint16_t maxIndex - Index of the receive buffer (rxBuff) that directly follows the bytes processed
 	  by the calling of this member function
-	*//*
+	*/
 	template <typename T>
 	uint16_t rxObj(const T& val, const uint16_t& index = 0, const uint16_t& len = sizeof(T))
 	{
 		return packet.rxObj(val, index, len);
 	}
 
-*/
+
 	/*
 	 uint8_t SPITransfer::sendDatum(const T &val, const uint16_t &len=sizeof(T))
 	 Description:
@@ -91,7 +96,7 @@ class SPITransfer
 	 Return:
 	 -------
 	  * uint8_t - Number of payload bytes included in packet
-	*//*
+	*/
 	template <typename T>
 	uint8_t sendDatum(const T& val, const uint16_t& len = sizeof(T))
 	{
@@ -100,9 +105,23 @@ class SPITransfer
 
 
   private: // <<---------------------------------------//private
-	SPIClass* port;
-	uint8_t   ssPin;
+	SPIClass*   port;
+	uint8_t     ssPin;
+	SPISettings settings;
+
+	EventResponder   event;
+	functionPtr      doneCallback = NULL;
+	volatile bool    txBusy       = false;
+	volatile uint16_t frameLen    = 0;
+
+	alignas(32) uint8_t txFrame[SPI_FRAME_BUFF_SIZE]; // Cache line aligned, arm_dcache_delete() must not discard the neighbouring members
+	alignas(32) uint8_t rxFrame[SPI_FRAME_BUFF_SIZE];
+	volatile uint16_t   rxPos = 0; // Written by the DMA interrupt at the end of a transfer
+	volatile uint16_t   rxLen = 0;
+
+
+	uint16_t    buildFrame(const uint16_t& messageLen, const uint8_t& packetID);
+	static void transferDone(EventResponderRef _event);
 };
 
-#endif // not (defined(MBED_H) || defined(__SAM3X8E__))
-*/
+#endif // defined(SPI_HAS_TRANSFER_ASYNC)
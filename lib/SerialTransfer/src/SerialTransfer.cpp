@@ -17,8 +17,11 @@
 */
 void SerialTransfer::begin(Stream& _port, const configST configs)
 {
-	port = &_port;
+	port      = &_port;
+	debugPort = configs.debugPort;
+	debug     = configs.debug;
 	packet.begin(configs);
+	packet.reserveIDs(RESERVED_ID_MIN);
 }
 
 
@@ -38,9 +41,12 @@ void SerialTransfer::begin(Stream& _port, const configST configs)
 */
 void SerialTransfer::begin(Stream& _port, const bool _debug, Stream& _debugPort, uint32_t _timeout)
 {
-	port    = &_port;
-	timeout = _timeout;
+	port      = &_port;
+	timeout   = _timeout;
+	debugPort = &_debugPort;
+	debug     = _debug;
 	packet.begin(_debug, _debugPort, _timeout);
+	packet.reserveIDs(RESERVED_ID_MIN);
 }
 
 
@@ -53,19 +59,53 @@ void SerialTransfer::begin(Stream& _port, const bool _debug, Stream& _debugPort,
  -------
   * const uint16_t &messageLen - Number of values in txBuff
   to send as the payload in the next packet
-  * const uint8_t packetID - The packet 8-bit identifier
+  * const uint8_t packetID - The packet 8-bit identifier (below
+  RESERVED_ID_MIN)
  Return:
  -------
   * uint8_t numBytesIncl - Number of payload bytes included in packet
+  (0 if the packet ID is reserved)
 */
 uint8_t SerialTransfer::sendData(const uint16_t& messageLen, const uint8_t packetID)
+{
+	if (packet.reservedID(packetID))
+	{
+		if (debug)
+			debugPort->println("ERROR: RESERVED_ID");
+
+		return 0;
+	}
+
+	return sendBuff(packet.txBuff, messageLen, packetID);
+}
+
+
+/*
+ uint8_t SerialTransfer::sendBuff(uint8_t arr[], const uint16_t &messageLen, const uint8_t packetID)
+ Description:
+ ------------
+  * Send a specified number of bytes of a buffer in packetized form
+  (the buffer is stuffed in place)
+ Inputs:
+ -------
+  * uint8_t arr[] - Payload buffer of at least messageLen bytes
+  * const uint16_t &messageLen - Number of values in arr[]
+  to send as the payload in the next packet (at most MAX_PACKET_SIZE)
+  * const uint8_t packetID - The packet 8-bit identifier
+ Return:
+ -------
+  * uint8_t numBytesIncl - Number of payload bytes included in packet
+*/
+uint8_t SerialTransfer::sendBuff(uint8_t arr[], const uint16_t& messageLen, const uint8_t packetID)
 {
 	uint8_t numBytesIncl;
 
-	numBytesIncl = packet.constructPacket(messageLen, packetID);
+	txqFinish(); // do not split a queued packet being written
+
+	numBytesIncl = packet.constructPacket(arr, messageLen, packetID);
 	port->write(packet.preamble, sizeof(packet.preamble));
-	port->write(packet.txBuff, numBytesIncl);
-	port->write(packet.postamble, sizeof(packet.postamble));
+	port->write(arr, numBytesIncl);
+	port->write(packet.postamble, packet.postambleLen);
 
 	return numBytesIncl;
 }
@@ -76,7 +116,10 @@ uint8_t SerialTransfer::sendData(const uint16_t& messageLen, const uint8_t packe
  Description:
  ------------
   * Parses incoming serial data, analyzes packet contents,
-  and reports errors/successful packet reception
+  and reports errors/successful packet reception. All the available
+  bytes are read in the block set with "setRxBlock()" with a single
+  "readBytes()" (a byte at a time without), and the bytes following a
+  complete packet are kept for the next call
  Inputs:
  -------
   * void
@@ -89,17 +132,78 @@ uint8_t SerialTransfer::available()
 	bool    valid   = false;
 	uint8_t recChar = 0xFF;
 
-	if (port->available())
+	txqUpdate();
+	streamUpdate();
+	arqUpdate();
+
+	if (arqDeliver()) // reliable packets received out of order and now in sequence
+		return bytesRead;
+
+	if ((rxPos < rxLen) || port->available())
 	{
 		valid = true;
 
-		while (port->available())
+		while ((rxPos < rxLen) || port->available())
 		{
-			recChar = port->read();
+			if (rxPos == rxLen) // block parsed, read all the available bytes at once
+			{
+				int avail = port->available();
+
+				if (rxBlock)
+					rxLen = port->readBytes(rxBlock, (avail < (int)rxBlockLen) ? avail : rxBlockLen);
+				else
+					rxLen = port->readBytes(&rxByte, 1);
 
-			bytesRead = packet.parse(recChar, valid);
+				rxPos = 0;
+
+				if (rxLen == 0)
+					break;
+			}
+
+			rxPos += packet.parse((rxBlock ? rxBlock : &rxByte) + rxPos, rxLen - rxPos);
+
+			bytesRead = packet.bytesRead;
 			status    = packet.status;
 
+			if ((status == NEW_DATA) && (packet.currentPacketID() == STREAM_DATA_ID))
+			{
+				streamData(bytesRead);
+				bytesRead = 0;
+				status    = CONTINUE;
+			}
+			else if ((status == NEW_DATA) && (packet.currentPacketID() == STREAM_ACK_ID))
+			{
+				streamAck(bytesRead);
+				bytesRead = 0;
+				status    = CONTINUE;
+			}
+			else if ((status == NEW_DATA) && (packet.currentPacketID() == ARQ_DATA_ID))
+			{
+				arqData(bytesRead);
+
+				if (!arqDeliver())
+				{
+					bytesRead = 0;
+					status    = CONTINUE;
+				}
+			}
+			else if ((status == NEW_DATA) && (packet.currentPacketID() == ARQ_SKIP_ID))
+			{
+				arqSkip(bytesRead);
+
+				if (!arqDeliver())
+				{
+					bytesRead = 0;
+					status    = CONTINUE;
+				}
+			}
+			else if ((status == NEW_DATA) && ((packet.currentPacketID() == ARQ_ACK_ID) || (packet.currentPacketID() == ARQ_NACK_ID)))
+			{
+				arqAck(bytesRead, packet.currentPacketID() == ARQ_NACK_ID);
+				bytesRead = 0;
+				status    = CONTINUE;
+			}
+
 			if (status != CONTINUE)
 			{
 				if (status < 0)
@@ -181,6 +285,1171 @@ void SerialTransfer::reset()
 	while (port->available())
 		port->read();
 
+	rxPos = 0;
+	rxLen = 0;
+
 	packet.reset();
 	status = packet.status;
 }
+
+
+/*
+ bool SerialTransfer::setCRC(const uint8_t& crcType)
+ Description:
+ ------------
+  * Selects the CRC of the packets of this instance: CRC_8 (default,
+  compatible with the other SerialTransfer implementations), CRC_16
+  or CRC_32. Both ends must use the same CRC
+ Inputs:
+ -------
+  * const uint8_t& crcType - CRC_8, CRC_16 or CRC_32
+ Return:
+ -------
+  * bool - Whether or not the CRC type is known (the previous CRC is
+  kept otherwise)
+*/
+bool SerialTransfer::setCRC(const uint8_t& crcType)
+{
+	return packet.setCRC(crcType);
+}
+
+/*
+ bool SerialTransfer::sendStream(const uint8_t buff[], const uint16_t &len, const uint32_t &streamTimeout)
+ Description:
+ ------------
+  * Starts the non-blocking transfer of a stream of up to 65535 bytes
+  split in fragments of STREAM_FRAG_SIZE bytes. Up to STREAM_WINDOW
+  fragments are sent without waiting for their acknowledgement, and the
+  fragments not acknowledged within the timeout are sent again. The
+  transfer progresses in "tick()" or "available()", which must be called
+  often, and the buffer must not change until "streamBusy()" is false.
+  The fragments are built in the buffer set with "setSendBuffer()"
+ Inputs:
+ -------
+  * const uint8_t buff[] - Stream bytes
+  * const uint16_t &len - Number of stream bytes
+  * const uint32_t &streamTimeout - Number of ms to wait for an
+  acknowledgement before sending the fragments again
+ Return:
+ -------
+  * bool - Whether or not the transfer was started (false if another
+  stream is being sent or the send buffer is not set)
+*/
+bool SerialTransfer::sendStream(const uint8_t buff[], const uint16_t& len, const uint32_t& _streamTimeout)
+{
+	if (streamTxBusy || !txScratch || (buff == NULL) || (len == 0))
+		return false;
+
+	streamTxBuff    = buff;
+	streamTxLen     = len;
+	streamTxFrags   = (len + STREAM_FRAG_SIZE - 1) / STREAM_FRAG_SIZE;
+	streamTxNext    = 0;
+	streamTxAcked   = 0;
+	streamTxRewound = false;
+	streamTxRetries = 0;
+	streamTxTime    = millis();
+	streamTimeout   = _streamTimeout;
+	streamTxID++;
+	streamTxBusy    = true;
+
+	streamUpdate();
+	return true;
+}
+
+
+/*
+ bool SerialTransfer::streamBusy()
+ Description:
+ ------------
+  * Returns whether or not a stream is being sent
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not a stream is being sent
+*/
+bool SerialTransfer::streamBusy()
+{
+	return streamTxBusy;
+}
+
+
+/*
+ uint16_t SerialTransfer::streamSent()
+ Description:
+ ------------
+  * Returns the number of bytes of the latest stream acknowledged by
+  the receiver. When "streamBusy()" is false, the stream was delivered
+  if this is equal to its length, or aborted after STREAM_MAX_RETRIES
+  timeouts otherwise
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - Number of stream bytes acknowledged
+*/
+uint16_t SerialTransfer::streamSent()
+{
+	if (streamTxAcked == streamTxFrags)
+		return streamTxLen;
+
+	return streamTxAcked * STREAM_FRAG_SIZE;
+}
+
+
+/*
+ void SerialTransfer::rxStream(uint8_t buff[], const uint16_t &maxLen)
+ Description:
+ ------------
+  * Sets the buffer where received streams are reassembled. Fragments
+  are copied directly at their position, in any order
+ Inputs:
+ -------
+  * uint8_t buff[] - Reassembly buffer
+  * const uint16_t &maxLen - Size of the reassembly buffer (longer
+  streams are ignored)
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::rxStream(uint8_t buff[], const uint16_t& maxLen)
+{
+	streamRxBuff   = buff;
+	streamRxMax    = maxLen;
+	streamRxActive = false;
+	streamRxDone   = 0;
+}
+
+
+/*
+ uint16_t SerialTransfer::streamAvailable()
+ Description:
+ ------------
+  * Returns the length of a stream completely received in the
+  reassembly buffer, once per stream. The next stream is received only
+  after this call, so that it does not overwrite an unread stream
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint16_t - Number of stream bytes (0 if no new stream)
+*/
+uint16_t SerialTransfer::streamAvailable()
+{
+	uint16_t len = streamRxDone;
+
+	streamRxDone = 0;
+	return len;
+}
+
+
+/*
+ void SerialTransfer::streamUpdate()
+ Description:
+ ------------
+  * Sends the fragments of the stream allowed by the window and goes
+  back to the first fragment not acknowledged after a timeout
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::streamUpdate()
+{
+	if (!streamTxBusy)
+		return;
+
+	if ((millis() - streamTxTime) > streamTimeout)
+	{
+		if (++streamTxRetries > STREAM_MAX_RETRIES)
+		{
+			streamTxBusy = false;
+
+			if (debug)
+				debugPort->println("ERROR: STREAM_TIMEOUT");
+
+			return;
+		}
+
+		streamTxNext = streamTxAcked;
+		streamTxTime = millis();
+	}
+
+	while (txScratch && (streamTxNext < streamTxFrags) && (streamTxNext < (streamTxAcked + STREAM_WINDOW)))
+	{
+		uint32_t offset = (uint32_t)streamTxNext * STREAM_FRAG_SIZE;
+		uint8_t  len    = ((streamTxLen - offset) < STREAM_FRAG_SIZE) ? (streamTxLen - offset) : STREAM_FRAG_SIZE;
+
+		txScratch[0] = streamTxID;
+		txScratch[1] = streamTxNext & 0xFF;
+		txScratch[2] = streamTxNext >> 8;
+		txScratch[3] = streamTxLen & 0xFF;
+		txScratch[4] = streamTxLen >> 8;
+		memcpy(txScratch + STREAM_HEADER_SIZE, streamTxBuff + offset, len);
+
+		sendBuff(txScratch, STREAM_HEADER_SIZE + len, STREAM_DATA_ID);
+		streamTxNext++;
+	}
+}
+
+
+/*
+ void SerialTransfer::streamData(const uint8_t &len)
+ Description:
+ ------------
+  * Copies a received stream fragment in the reassembly buffer and
+  acknowledges the fragments received in order, every half window,
+  when the stream is complete, or when a fragment is out of order.
+  A new stream is refused (not acknowledged) while the previous one
+  is complete and not read yet with "streamAvailable()"
+ Inputs:
+ -------
+  * const uint8_t &len - Number of payload bytes of the fragment packet
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::streamData(const uint8_t& len)
+{
+	const uint8_t* rx = packet.rxBuff;
+
+	if ((streamRxBuff == NULL) || (len <= STREAM_HEADER_SIZE))
+		return;
+
+	uint8_t  id    = rx[0];
+	uint16_t seq   = rx[1] | (rx[2] << 8);
+	uint16_t total = rx[3] | (rx[4] << 8);
+
+	if (!streamRxActive || (id != streamRxID))
+	{
+		if (streamRxLast && (id == streamRxLastID)) // acknowledgement of a complete stream was lost
+		{
+			ctrlBuff[0] = id;
+			ctrlBuff[1] = streamRxFrags & 0xFF;
+			ctrlBuff[2] = streamRxFrags >> 8;
+			sendBuff(ctrlBuff, 3, STREAM_ACK_ID);
+			return;
+		}
+
+		if (total > streamRxMax)
+		{
+			if (debug)
+				debugPort->println("ERROR: STREAM_TOO_LONG");
+
+			return;
+		}
+
+		if (streamRxDone) // previous stream not read yet, the sender retries until "streamAvailable()" is called
+		{
+			if (debug)
+				debugPort->println("ERROR: STREAM_UNREAD");
+
+			return;
+		}
+
+		streamRxID     = id;
+		streamRxLen    = total;
+		streamRxFrags  = (total + STREAM_FRAG_SIZE - 1) / STREAM_FRAG_SIZE;
+		streamRxNext   = 0;
+		streamRxActive = true;
+		streamRxLast   = false;
+		streamRxMap    = 0;
+	}
+
+	uint32_t offset = (uint32_t)seq * STREAM_FRAG_SIZE;
+
+	if ((seq >= streamRxFrags) || (total != streamRxLen))
+		return;
+
+	uint8_t fragLen = ((streamRxLen - offset) < STREAM_FRAG_SIZE) ? (streamRxLen - offset) : STREAM_FRAG_SIZE;
+
+	if ((len - STREAM_HEADER_SIZE) != fragLen)
+		return;
+
+	if (seq >= streamRxNext) // not a duplicate of a fragment received in order
+	{
+		uint16_t ahead = seq - streamRxNext;
+
+		if (ahead >= STREAM_WINDOW) // beyond the window of the sender
+			return;
+
+		if (!(streamRxMap & (1UL << ahead)))
+		{
+			memcpy(streamRxBuff + offset, rx + STREAM_HEADER_SIZE, fragLen);
+			streamRxMap |= 1UL << ahead;
+		}
+	}
+
+	bool inOrder = (seq == streamRxNext);
+
+	while ((streamRxNext < streamRxFrags) && (streamRxMap & 1))
+	{
+		streamRxMap >>= 1;
+		streamRxNext++;
+	}
+
+	if (streamRxNext == streamRxFrags)
+	{
+		streamRxDone   = streamRxLen;
+		streamRxActive = false;
+		streamRxLast   = true;
+		streamRxLastID = id;
+	}
+
+	if (!inOrder || streamRxLast || !(streamRxNext % (STREAM_WINDOW / 2)))
+	{
+		ctrlBuff[0] = id;
+		ctrlBuff[1] = streamRxNext & 0xFF;
+		ctrlBuff[2] = streamRxNext >> 8;
+		sendBuff(ctrlBuff, 3, STREAM_ACK_ID);
+	}
+}
+
+
+/*
+ void SerialTransfer::streamAck(const uint8_t &len)
+ Description:
+ ------------
+  * Slides the window of the stream being sent to the first fragment
+  not acknowledged yet. A repeated acknowledgement while fragments are
+  in flight means a lost fragment, which is sent again without waiting
+  for the timeout
+ Inputs:
+ -------
+  * const uint8_t &len - Number of payload bytes of the acknowledgement packet
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::streamAck(const uint8_t& len)
+{
+	const uint8_t* rx = packet.rxBuff;
+
+	if (!streamTxBusy || (len < 3) || (rx[0] != streamTxID))
+		return;
+
+	uint16_t next = rx[1] | (rx[2] << 8);
+
+	if (next > streamTxFrags)
+		return;
+
+	if (next > streamTxAcked)
+	{
+		streamTxAcked   = next;
+		streamTxTime    = millis();
+		streamTxRewound = false;
+		streamTxRetries = 0;
+
+		if (streamTxNext < next)
+			streamTxNext = next;
+
+		if (streamTxAcked == streamTxFrags)
+			streamTxBusy = false;
+	}
+	else if (!streamTxRewound && (streamTxNext > streamTxAcked))
+	{
+		streamTxNext    = streamTxAcked;
+		streamTxRewound = true;
+	}
+}
+
+
+/*
+ bool SerialTransfer::sendReliable(const uint16_t &messageLen, const uint8_t packetID)
+ Description:
+ ------------
+  * Sends a specified number of bytes of txBuff in a packet whose delivery
+  is guaranteed (selective-repeat ARQ). The packet is copied in a queue of
+  ARQ_WINDOW packets and sent again, until acknowledged, after the timeout
+  or as soon as the receiver reports it missing. The receiver delivers
+  reliable packets once and in order through "available()" with their
+  own ID. Retransmissions happen in "tick()" or "available()", which must
+  be called often. The queue is set with "setReliableBuffers()", and
+  the packets are built in the buffer set with "setSendBuffer()"
+ Inputs:
+ -------
+  * const uint16_t &messageLen - Number of values in txBuff
+  to send as the payload (at most ARQ_MAX_PAYLOAD)
+  * const uint8_t packetID - The packet 8-bit identifier (below
+  RESERVED_ID_MIN)
+ Return:
+ -------
+  * bool - Whether or not the packet was queued (false if the queue is
+  full or not set, the send buffer is not set, the payload is too long or
+  the packet ID is reserved)
+*/
+bool SerialTransfer::sendReliable(const uint16_t& messageLen, const uint8_t packetID)
+{
+	if (!arqTx || !txScratch || (messageLen > ARQ_MAX_PAYLOAD) || (reliablePending() >= ARQ_WINDOW) || packet.reservedID(packetID))
+		return false;
+
+	if (arqSession == 0) // new session, so that the receiver restarts from our sequence numbers
+	{
+		uint32_t t = micros();
+
+		arqSession = (t ^ (t >> 8) ^ (t >> 16)) | 1;
+	}
+
+	arqSlotST& slot = arqTx[arqTxNext & (ARQ_WINDOW - 1)];
+
+	memcpy(slot.buff, packet.txBuff, messageLen);
+	slot.len     = messageLen;
+	slot.id      = packetID;
+	slot.full    = true;
+	slot.retries = 0;
+
+	arqSend(arqTxNext++);
+	return true;
+}
+
+
+/*
+ uint8_t SerialTransfer::reliablePending()
+ Description:
+ ------------
+  * Returns the number of reliable packets not acknowledged yet
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint8_t - Number of reliable packets in the queue
+*/
+uint8_t SerialTransfer::reliablePending()
+{
+	return arqTxNext - arqTxBase;
+}
+
+
+/*
+ uint32_t SerialTransfer::reliableLost()
+ Description:
+ ------------
+  * Returns the number of reliable packets dropped after "arqRetries"
+  retransmissions without acknowledgement
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint32_t - Number of reliable packets dropped
+*/
+uint32_t SerialTransfer::reliableLost()
+{
+	return arqTxLost;
+}
+
+
+/*
+ void SerialTransfer::setReliableTimeout(const uint32_t &_arqTimeout, const uint8_t &_arqRetries)
+ Description:
+ ------------
+  * Sets the retransmission timeout of the reliable packets
+ Inputs:
+ -------
+  * const uint32_t &_arqTimeout - Number of ms to wait for an
+  acknowledgement before sending a packet again (more than the round
+  trip time of the link)
+  * const uint8_t &_arqRetries - Number of retransmissions before a
+  packet is dropped
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::setReliableTimeout(const uint32_t& _arqTimeout, const uint8_t& _arqRetries)
+{
+	arqTimeout = _arqTimeout;
+	arqRetries = _arqRetries;
+}
+
+
+/*
+ void SerialTransfer::setReliableBuffers(arqSlotST txSlots[], arqSlotST rxSlots[])
+ Description:
+ ------------
+  * Sets the slots of the reliable packets, which are not allocated by
+  the class. The transmit slots are needed only to send reliable packets
+  and the receive slots only to receive them (they are ignored without,
+  and the sender drops them after the retries)
+ Inputs:
+ -------
+  * arqSlotST txSlots[] - ARQ_WINDOW slots of the packets sent and not
+  acknowledged yet, or NULL
+  * arqSlotST rxSlots[] - ARQ_WINDOW slots of the packets received and
+  not delivered yet, or NULL
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::setReliableBuffers(arqSlotST txSlots[], arqSlotST rxSlots[])
+{
+	arqTx      = txSlots;
+	arqSession = 0; // new session from the next packet sent
+	arqTxBase  = 0;
+	arqTxNext  = 0;
+
+	if (arqTx)
+		for (uint8_t i = 0; i < ARQ_WINDOW; i++)
+			arqTx[i].full = false;
+
+	arqRx = rxSlots;
+
+	if (arqRx)
+		arqRestart(0, 0); // restart from the next packet received
+}
+
+
+/*
+ void SerialTransfer::setSendBuffer(uint8_t buff[])
+ Description:
+ ------------
+  * Sets the buffer where the stream fragments and the reliable packets
+  are built before being sent, which is not allocated by the class. It
+  is needed only to send streams or reliable packets
+ Inputs:
+ -------
+  * uint8_t buff[] - Buffer of MAX_PACKET_SIZE bytes, or NULL
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::setSendBuffer(uint8_t buff[])
+{
+	txScratch = buff;
+}
+
+
+/*
+ void SerialTransfer::setRxBlock(uint8_t buff[], const uint16_t &len)
+ Description:
+ ------------
+  * Sets the block where "available()" reads all the available bytes of
+  the port at once, which is not allocated by the class. Without it, the
+  port is read a byte at a time. The bytes read and not parsed yet are
+  dropped, so set it before the first packet is received
+ Inputs:
+ -------
+  * uint8_t buff[] - Block (e.g. RX_BLOCK_SIZE bytes), or NULL
+  * const uint16_t &len - Size of the block
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::setRxBlock(uint8_t buff[], const uint16_t& len)
+{
+	rxBlock    = (buff && len) ? buff : NULL;
+	rxBlockLen = rxBlock ? len : 0;
+	rxPos      = 0;
+	rxLen      = 0;
+}
+
+
+/*
+ void SerialTransfer::arqUpdate()
+ Description:
+ ------------
+  * Sends again the reliable packets not acknowledged within the timeout,
+  drops the ones out of retries (and tells the receiver to skip them)
+  and slides the queue over the acknowledged ones. At most ARQ_WINDOW
+  packets are checked. On the receiver side, requests again the missing
+  packets after the timeout, in case the requests were lost
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::arqUpdate()
+{
+	uint32_t now     = millis();
+	bool     dropped = false;
+
+	for (uint8_t seq = arqTxBase; seq != arqTxNext; seq++)
+	{
+		arqSlotST& slot = arqTx[seq & (ARQ_WINDOW - 1)];
+
+		if (!slot.full || ((now - slot.sent) <= arqTimeout))
+			continue;
+
+		if (slot.retries >= arqRetries)
+		{
+			slot.full = false;
+			arqTxLost++;
+			dropped   = true;
+
+			if (debug)
+				debugPort->println("ERROR: ARQ_TIMEOUT");
+
+			continue;
+		}
+
+		slot.retries++;
+		arqSend(seq);
+	}
+
+	while ((arqTxBase != arqTxNext) && !arqTx[arqTxBase & (ARQ_WINDOW - 1)].full)
+		arqTxBase++;
+
+	if (dropped)
+		arqSendSkip();
+
+	if (arqRx && (arqRxTop != arqRxSkip) && ((now - arqRxNackTime) > arqTimeout))
+		arqNack(true);
+}
+
+
+/*
+ void SerialTransfer::arqSend(const uint8_t &seq)
+ Description:
+ ------------
+  * Sends (again) a reliable packet of the queue
+ Inputs:
+ -------
+  * const uint8_t &seq - Sequence number of the packet
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::arqSend(const uint8_t& seq)
+{
+	arqSlotST& slot = arqTx[seq & (ARQ_WINDOW - 1)];
+
+	if (!txScratch)
+		return;
+
+	txScratch[0] = arqSession;
+	txScratch[1] = seq;
+	txScratch[2] = slot.id;
+	memcpy(txScratch + ARQ_HEADER_SIZE, slot.buff, slot.len);
+
+	sendBuff(txScratch, ARQ_HEADER_SIZE + slot.len, ARQ_DATA_ID);
+	slot.sent = millis();
+}
+
+
+/*
+ void SerialTransfer::arqData(const uint8_t &len)
+ Description:
+ ------------
+  * Acknowledges a received reliable packet (again, if duplicated), keeps
+  it until the previous ones are delivered and requests the missing
+  packets that precede it. Missing packets are skipped once the sender
+  is past them, i.e. it dropped them (see also "arqSkip()")
+ Inputs:
+ -------
+  * const uint8_t &len - Number of payload bytes of the packet
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::arqData(const uint8_t& len)
+{
+	const uint8_t* rx = packet.rxBuff;
+
+	if (!arqRx || (len < ARQ_HEADER_SIZE))
+		return;
+
+	uint8_t session = rx[0];
+	uint8_t seq     = rx[1];
+
+	if (session != arqRxSession) // first packet from the sender, or the sender restarted (from sequence number 0)
+		arqRestart(session, 0);
+
+	uint8_t ahead = seq - arqRxBase;
+
+	if ((ahead >= ARQ_WINDOW) && (ahead < 0x80)) // the sender dropped the missing packets
+	{
+		uint8_t skip = seq - (ARQ_WINDOW - 1);
+
+		if ((uint8_t)(skip - arqRxSkip) < 0x80)
+			arqRxSkip = skip;
+
+		if ((uint8_t)(skip - arqRxTop) < 0x80)
+			arqRxTop = skip;
+
+		while ((arqRxBase != arqRxSkip) && !arqRx[arqRxBase & (ARQ_WINDOW - 1)].full)
+			arqNext();
+
+		ahead = seq - arqRxBase;
+	}
+
+	if ((ahead >= ARQ_WINDOW) && (ahead < (uint8_t)(0 - ARQ_WINDOW))) // not in the window (yet) nor a duplicate
+		return;
+
+	ctrlBuff[0] = session;
+	ctrlBuff[1] = seq;
+	sendBuff(ctrlBuff, 2, ARQ_ACK_ID);
+
+	if (ahead >= ARQ_WINDOW) // duplicate of a delivered packet, whose acknowledgement was lost
+		return;
+
+	arqSlotST& slot = arqRx[seq & (ARQ_WINDOW - 1)];
+
+	if (!slot.full)
+	{
+		slot.len  = len - ARQ_HEADER_SIZE;
+		slot.id   = rx[2];
+		slot.full = true;
+		memcpy(slot.buff, rx + ARQ_HEADER_SIZE, slot.len);
+	}
+
+	if ((uint8_t)(seq - arqRxTop) < 0x80)
+		arqRxTop = seq + 1;
+
+	arqNack(false);
+}
+
+
+/*
+ void SerialTransfer::arqAck(const uint8_t &len, const bool &nack)
+ Description:
+ ------------
+  * Processes an acknowledgement of a reliable packet, or a request of
+  missing reliable packets, which are sent again immediately
+ Inputs:
+ -------
+  * const uint8_t &len - Number of payload bytes of the packet
+  * const bool &nack - Whether the packet is a request of missing packets
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::arqAck(const uint8_t& len, const bool& nack)
+{
+	const uint8_t* rx = packet.rxBuff;
+
+	bool           skip = false;
+
+	if ((len < 2) || (rx[0] != arqSession))
+		return;
+
+	for (uint8_t i = 1; i < len; i++)
+	{
+		uint8_t seq = rx[i];
+
+		if ((uint8_t)(seq - arqTxBase) >= reliablePending())
+		{
+			if (nack && ((uint8_t)(arqTxBase - seq) <= ARQ_WINDOW)) // dropped, the skip was lost
+				skip = true;
+
+			continue;
+		}
+
+		arqSlotST& slot = arqTx[seq & (ARQ_WINDOW - 1)];
+
+		if (!slot.full)
+			continue;
+
+		if (!nack)
+			slot.full = false;
+		else if (slot.retries < arqRetries)
+		{
+			slot.retries++;
+			arqSend(seq);
+		}
+	}
+
+	while ((arqTxBase != arqTxNext) && !arqTx[arqTxBase & (ARQ_WINDOW - 1)].full)
+		arqTxBase++;
+
+	if (skip)
+		arqSendSkip();
+}
+
+
+/*
+ void SerialTransfer::arqSkip(const uint8_t &len)
+ Description:
+ ------------
+  * Processes the sequence number of the oldest reliable packet not
+  dropped by the sender. The missing packets before it are never sent
+  again, so they are skipped and the following ones are delivered
+ Inputs:
+ -------
+  * const uint8_t &len - Number of payload bytes of the packet
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::arqSkip(const uint8_t& len)
+{
+	const uint8_t* rx = packet.rxBuff;
+
+	if (!arqRx || (len < 2))
+		return;
+
+	uint8_t session = rx[0];
+	uint8_t skip    = rx[1];
+
+	if (session != arqRxSession) // the first packets from the sender were dropped
+	{
+		arqRestart(session, skip);
+		return;
+	}
+
+	if ((uint8_t)(skip - arqRxSkip) < 0x80)
+		arqRxSkip = skip;
+
+	if ((uint8_t)(skip - arqRxTop) < 0x80)
+		arqRxTop = skip;
+}
+
+
+/*
+ void SerialTransfer::arqSendSkip()
+ Description:
+ ------------
+  * Sends the sequence number of the oldest reliable packet not dropped
+  (i.e. the base of the transmit queue), so that the receiver skips the
+  dropped ones
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::arqSendSkip()
+{
+	if (!arqSession)
+		return;
+
+	ctrlBuff[0] = arqSession;
+	ctrlBuff[1] = arqTxBase;
+	sendBuff(ctrlBuff, 2, ARQ_SKIP_ID);
+}
+
+
+/*
+ void SerialTransfer::arqNack(const bool &again)
+ Description:
+ ------------
+  * Requests the missing reliable packets, between the next one to
+  deliver (or the skipped ones) and the newest one received
+ Inputs:
+ -------
+  * const bool &again - Whether or not to request again the packets
+  already requested
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::arqNack(const bool& again)
+{
+	uint8_t missing = 1;
+
+	ctrlBuff[0] = arqRxSession;
+
+	for (uint8_t s = arqRxSkip; s != arqRxTop; s++)
+	{
+		arqSlotST& gap = arqRx[s & (ARQ_WINDOW - 1)];
+
+		if (!gap.full && (again || !gap.nacked))
+		{
+			gap.nacked          = true;
+			ctrlBuff[missing++] = s;
+		}
+	}
+
+	if (missing > 1)
+	{
+		sendBuff(ctrlBuff, missing, ARQ_NACK_ID);
+		arqRxNackTime = millis();
+	}
+}
+
+
+/*
+ void SerialTransfer::arqRestart(const uint8_t &session, const uint8_t &base)
+ Description:
+ ------------
+  * Restarts the reception of the reliable packets of a new session,
+  discarding the packets of the previous one
+ Inputs:
+ -------
+  * const uint8_t &session - Session of the sender
+  * const uint8_t &base - Sequence number of the next packet to deliver
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::arqRestart(const uint8_t& session, const uint8_t& base)
+{
+	arqRxSession  = session;
+	arqRxBase     = base;
+	arqRxTop      = base;
+	arqRxSkip     = base;
+	arqRxNackTime = millis();
+
+	for (uint8_t i = 0; i < ARQ_WINDOW; i++)
+	{
+		arqRx[i].full   = false;
+		arqRx[i].nacked = false;
+	}
+}
+
+
+/*
+ void SerialTransfer::arqNext()
+ Description:
+ ------------
+  * Frees the slot of the next reliable packet to deliver and moves to
+  the following one (the skipped and newest sequence numbers are never
+  behind it)
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::arqNext()
+{
+	arqSlotST& slot = arqRx[arqRxBase & (ARQ_WINDOW - 1)];
+
+	slot.full   = false;
+	slot.nacked = false;
+
+	if (arqRxSkip == arqRxBase)
+		arqRxSkip++;
+
+	if (arqRxTop == arqRxBase)
+		arqRxTop++;
+
+	arqRxBase++;
+}
+
+
+/*
+ bool SerialTransfer::arqDeliver()
+ Description:
+ ------------
+  * Delivers the next reliable packet in sequence, if received, as a new
+  packet with its own ID in the receive buffer (rxBuff). The missing
+  packets dropped by the sender are skipped first
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * bool - Whether or not a packet was delivered
+*/
+bool SerialTransfer::arqDeliver()
+{
+	if (!arqRx)
+		return false;
+
+	while ((arqRxBase != arqRxSkip) && !arqRx[arqRxBase & (ARQ_WINDOW - 1)].full)
+		arqNext();
+
+	arqSlotST& slot = arqRx[arqRxBase & (ARQ_WINDOW - 1)];
+
+	if (!slot.full)
+		return false;
+
+	bytesRead = packet.deliver(slot.buff, slot.len, slot.id);
+	status    = packet.status;
+	arqNext();
+
+	return true;
+}
+
+
+/*
+ bool SerialTransfer::queueData(const uint16_t &messageLen, const uint8_t packetID, const uint8_t priority)
+ Description:
+ ------------
+  * Packetizes a specified number of bytes of txBuff into the transmit
+  queue, without writing to the port. Queued packets are written in
+  "tick()" or "available()", only as many bytes as "availableForWrite()"
+  of the port allows (whole packets if the port does not implement it),
+  by priority and in order within a priority. A packet
+  is never interrupted, so a high priority packet waits at most for the
+  end of the packet being written. The queue is set with "setTxQueue()"
+ Inputs:
+ -------
+  * const uint16_t &messageLen - Number of values in txBuff
+  to send as the payload in the next packet
+  * const uint8_t packetID - The packet 8-bit identifier (below
+  RESERVED_ID_MIN)
+  * const uint8_t priority - TX_PRIORITY_HIGH, TX_PRIORITY_NORMAL
+  or TX_PRIORITY_BULK
+ Return:
+ -------
+  * bool - Whether or not the packet was queued (false if the queue is
+  full or not set, or the packet ID is reserved)
+*/
+bool SerialTransfer::queueData(const uint16_t& messageLen, const uint8_t packetID, const uint8_t priority)
+{
+	uint8_t i = 0;
+
+	if (packet.reservedID(packetID))
+		return false;
+
+	while ((i < txqSlots) && txq[i].full)
+		i++;
+
+	if (i == txqSlots)
+		return false;
+
+	txSlotST& slot         = txq[i];
+	uint8_t   numBytesIncl = packet.constructPacket(messageLen, packetID);
+
+	memcpy(slot.frame, packet.preamble, PREAMBLE_SIZE);
+	memcpy(slot.frame + PREAMBLE_SIZE, packet.txBuff, numBytesIncl);
+	memcpy(slot.frame + PREAMBLE_SIZE + numBytesIncl, packet.postamble, packet.postambleLen);
+
+	slot.len      = PREAMBLE_SIZE + numBytesIncl + packet.postambleLen;
+	slot.priority = priority;
+	slot.order    = txqOrder++;
+	slot.full     = true;
+
+	txqUpdate();
+	return true;
+}
+
+
+/*
+ uint8_t SerialTransfer::queued()
+ Description:
+ ------------
+  * Returns the number of packets in the transmit queue, including the
+  one being written
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * uint8_t - Number of queued packets
+*/
+uint8_t SerialTransfer::queued()
+{
+	uint8_t n = 0;
+
+	for (uint8_t i = 0; i < txqSlots; i++)
+		n += txq[i].full;
+
+	return n;
+}
+
+
+/*
+ void SerialTransfer::txqUpdate()
+ Description:
+ ------------
+  * Writes the queued packets as long as the port has room, choosing the
+  next packet by priority (then by order) at each packet boundary. The
+  port must implement "availableForWrite()": if it has never reported
+  any room (e.g. the default of Print, which returns 0), the queue would
+  never progress and the packets are written whole instead, blocking
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::txqUpdate()
+{
+	while (true)
+	{
+		if (txqCurrent == TXQ_NONE)
+		{
+			for (uint8_t i = 0; i < txqSlots; i++)
+			{
+				if (txq[i].full && ((txqCurrent == TXQ_NONE) ||
+				                    (txq[i].priority < txq[txqCurrent].priority) ||
+				                    ((txq[i].priority == txq[txqCurrent].priority) && ((int32_t)(txq[i].order - txq[txqCurrent].order) < 0))))
+					txqCurrent = i;
+			}
+
+			if (txqCurrent == TXQ_NONE)
+				return;
+
+			txqPos = 0;
+		}
+
+		txSlotST& slot = txq[txqCurrent];
+		int       room = port->availableForWrite();
+
+		if (room > 0)
+			txqRoomSeen = true;
+		else if (txqRoomSeen)
+			return;
+		else
+			room = slot.len - txqPos; // no room ever reported: port without availableForWrite(), whole packets written
+
+		uint16_t len = ((uint16_t)room < (slot.len - txqPos)) ? room : (slot.len - txqPos);
+
+		port->write(slot.frame + txqPos, len);
+		txqPos += len;
+
+		if (txqPos < slot.len)
+			return;
+
+		slot.full  = false;
+		txqCurrent = TXQ_NONE;
+	}
+}
+
+
+/*
+ void SerialTransfer::txqFinish()
+ Description:
+ ------------
+  * Writes the rest of the queued packet being written, if any, so that
+  a packet can be written directly
+ Inputs:
+ -------
+  * void
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::txqFinish()
+{
+	if (txqCurrent == TXQ_NONE)
+		return;
+
+	txSlotST& slot = txq[txqCurrent];
+
+	port->write(slot.frame + txqPos, slot.len - txqPos);
+
+	slot.full  = false;
+	txqCurrent = TXQ_NONE;
+}
+
+
+/*
+ void SerialTransfer::setTxQueue(txSlotST slots[], const uint8_t &numSlots)
+ Description:
+ ------------
+  * Sets the slots of the transmit queue of "queueData()", which are not
+  allocated by the class. The packets queued in the previous slots, if
+  any, are dropped (except the rest of the one being written)
+ Inputs:
+ -------
+  * txSlotST slots[] - Slots of the queued packets, or NULL
+  * const uint8_t &numSlots - Number of slots (e.g. TXQ_SLOTS, at most
+  254)
+ Return:
+ -------
+  * void
+*/
+void SerialTransfer::setTxQueue(txSlotST slots[], const uint8_t& numSlots)
+{
+	txqFinish();
+
+	txq         = slots;
+	txqSlots    = (slots && (numSlots < TXQ_NONE)) ? numSlots : 0;
+	txqRoomSeen = false;
+
+	for (uint8_t i = 0; i < txqSlots; i++)
+		txq[i].full = false;
+}
@@ -3,6 +3,62 @@
 #include "Packet.h"
 
 
+const uint16_t RX_BLOCK_SIZE = 256; // Suggested size of the block set with "setRxBlock()" (bytes read from the port at once)
+
+const uint8_t RESERVED_ID_MIN = 0xF9; // Packet IDs from RESERVED_ID_MIN to 0xFF are reserved for the streams and the reliable packets
+
+const uint8_t STREAM_DATA_ID = 0xFE; // Packet ID reserved for stream fragments
+const uint8_t STREAM_ACK_ID  = 0xFD; // Packet ID reserved for stream acknowledgements
+
+const uint8_t  STREAM_HEADER_SIZE = 5;                                   // Transfer ID, 16-bit sequence number, 16-bit stream length
+const uint8_t  STREAM_FRAG_SIZE   = MAX_PACKET_SIZE - STREAM_HEADER_SIZE; // Maximum stream bytes per fragment
+const uint8_t  STREAM_WINDOW      = 8;  // Maximum fragments sent and not acknowledged yet (at most 32)
+const uint8_t  STREAM_MAX_RETRIES = 10; // Timeouts without acknowledgement before a stream is aborted
+
+const uint8_t ARQ_DATA_ID = 0xFC; // Packet ID reserved for reliable packets
+const uint8_t ARQ_ACK_ID  = 0xFB; // Packet ID reserved for acknowledgements of reliable packets
+const uint8_t ARQ_NACK_ID = 0xFA; // Packet ID reserved for requests of missing reliable packets
+const uint8_t ARQ_SKIP_ID = 0xF9; // Packet ID reserved for the oldest reliable packet not dropped by the sender
+
+const uint8_t ARQ_HEADER_SIZE = 3;                                 // Session, sequence number, packet ID
+const uint8_t ARQ_MAX_PAYLOAD = MAX_PACKET_SIZE - ARQ_HEADER_SIZE; // Maximum payload bytes of a reliable packet
+const uint8_t ARQ_WINDOW      = 8;  // Reliable packets sent and not acknowledged yet (power of 2, at most 128)
+const uint8_t ARQ_MAX_RETRIES = 10; // Retransmissions before a reliable packet is dropped
+
+const uint8_t CTRL_BUFF_SIZE = (ARQ_WINDOW > 2) ? (ARQ_WINDOW + 1) : 3; // Longest control packet (request of missing reliable packets or stream acknowledgement)
+
+
+const uint8_t TX_PRIORITY_HIGH   = 0; // Commands, sent before any other queued packet
+const uint8_t TX_PRIORITY_NORMAL = 1;
+const uint8_t TX_PRIORITY_BULK   = 2; // Logs and other background traffic
+
+const uint8_t  TXQ_SLOTS      = 8;                                                    // Suggested packets in the transmit queue (at most 254)
+const uint8_t  TXQ_NONE       = 0xFF;                                                 // No queued packet being written
+const uint16_t TXQ_FRAME_SIZE = PREAMBLE_SIZE + MAX_PACKET_SIZE + MAX_POSTAMBLE_SIZE; // Maximum bytes of a packet on the wire
+
+
+struct arqSlotST
+{
+	uint8_t  buff[ARQ_MAX_PAYLOAD];
+	uint8_t  len     = 0;
+	uint8_t  id      = 0;
+	bool     full    = false; // TX: waiting for acknowledgement, RX: received and not delivered yet
+	bool     nacked  = false; // RX: missing packet requested
+	uint8_t  retries = 0;
+	uint32_t sent    = 0;
+};
+
+
+struct txSlotST
+{
+	uint8_t  frame[TXQ_FRAME_SIZE];
+	uint16_t len      = 0;
+	uint8_t  priority = 0;
+	uint32_t order    = 0;
+	bool     full     = false;
+};
+
+
 class SerialTransfer
 {
   public: // <<---------------------------------------//public
@@ -18,6 +74,26 @@ class SerialTransfer
 	bool    tick();
 	uint8_t currentPacketID();
 	void    reset();
+	bool    setCRC(const uint8_t& crcType);
+
+	bool     sendStream(const uint8_t buff[], const uint16_t& len, const uint32_t& streamTimeout = DEFAULT_TIMEOUT);
+	bool     streamBusy();
+	uint16_t streamSent();
+	void     rxStream(uint8_t buff[], const uint16_t& maxLen);
+	uint16_t streamAvailable();
+
+	bool     sendReliable(const uint16_t& messageLen, const uint8_t packetID = 0);
+	uint8_t  reliablePending();
+	uint32_t reliableLost();
+	void     setReliableTimeout(const uint32_t& _arqTimeout, const uint8_t& _arqRetries = ARQ_MAX_RETRIES);
+	void     setReliableBuffers(arqSlotST txSlots[], arqSlotST rxSlots[]);
+
+	void    setSendBuffer(uint8_t buff[]);
+	void    setRxBlock(uint8_t buff[], const uint16_t& len);
+
+	bool    queueData(const uint16_t& messageLen, const uint8_t packetID = 0, const uint8_t priority = TX_PRIORITY_NORMAL);
+	uint8_t queued();
+	void    setTxQueue(txSlotST slots[], const uint8_t& numSlots);
 
 
 	/*
@@ -99,4 +175,80 @@ class SerialTransfer
   private: // <<---------------------------------------//private
 	Stream* port;
 	uint32_t timeout;
+
+	Stream* debugPort = &Serial;
+	bool    debug     = false;
+
+	uint8_t* rxBlock    = NULL; // block from "setRxBlock()", NULL if the port is read a byte at a time (in rxByte)
+	uint16_t rxBlockLen = 0;
+	uint8_t  rxByte     = 0;
+	uint16_t rxPos      = 0;
+	uint16_t rxLen      = 0;
+
+	uint8_t* txScratch  = NULL; // MAX_PACKET_SIZE bytes from "setSendBuffer()", NULL if streams and reliable packets are not sent
+	uint8_t  ctrlBuff[CTRL_BUFF_SIZE];
+
+	const uint8_t* streamTxBuff    = NULL;
+	uint16_t       streamTxLen     = 0;
+	uint16_t       streamTxFrags   = 0;
+	uint16_t       streamTxNext    = 0;
+	uint16_t       streamTxAcked   = 0;
+	uint8_t        streamTxID      = 0;
+	bool           streamTxBusy    = false;
+	bool           streamTxRewound = false;
+	uint8_t        streamTxRetries = 0;
+	uint32_t       streamTxTime    = 0;
+	uint32_t       streamTimeout   = DEFAULT_TIMEOUT;
+
+	uint8_t* streamRxBuff   = NULL;
+	uint16_t streamRxMax    = 0;
+	uint16_t streamRxLen    = 0;
+	uint16_t streamRxFrags  = 0;
+	uint16_t streamRxNext   = 0;
+	uint16_t streamRxDone   = 0;
+	uint8_t  streamRxID     = 0;
+	uint8_t  streamRxLastID = 0;
+	bool     streamRxActive = false;
+	bool     streamRxLast   = false;
+	uint32_t streamRxMap    = 0; // fragments received from streamRxNext on (bit i for fragment streamRxNext + i)
+
+	arqSlotST* arqTx = NULL; // ARQ_WINDOW slots from "setReliableBuffers()", NULL if reliable packets are not sent
+	arqSlotST* arqRx = NULL; // ARQ_WINDOW slots from "setReliableBuffers()", NULL if reliable packets are not received
+
+	uint8_t  arqSession    = 0;
+	uint8_t  arqTxBase     = 0;
+	uint8_t  arqTxNext     = 0;
+	uint32_t arqTxLost     = 0;
+	uint32_t arqTimeout    = DEFAULT_TIMEOUT;
+	uint8_t  arqRetries    = ARQ_MAX_RETRIES;
+	uint8_t  arqRxSession  = 0;
+	uint8_t  arqRxBase     = 0;
+	uint8_t  arqRxTop      = 0; // next sequence number after the newest received packet
+	uint8_t  arqRxSkip     = 0; // missing packets before this are skipped (dropped by the sender)
+	uint32_t arqRxNackTime = 0;
+
+	txSlotST* txq         = NULL; // slots from "setTxQueue()", NULL if packets are not queued
+	uint8_t   txqSlots    = 0;
+	uint8_t   txqCurrent  = TXQ_NONE; // slot being written, TXQ_NONE if none
+	uint16_t  txqPos      = 0;
+	uint32_t  txqOrder    = 0;
+	bool      txqRoomSeen = false; // "availableForWrite()" of the port reported room since "setTxQueue()"
+
+
+	uint8_t sendBuff(uint8_t arr[], const uint16_t& messageLen, const uint8_t packetID);
+	void    streamUpdate();
+	void    streamData(const uint8_t& len);
+	void    streamAck(const uint8_t& len);
+	void    arqUpdate();
+	void    arqSend(const uint8_t& seq);
+	void    arqData(const uint8_t& len);
+	void    arqAck(const uint8_t& len, const bool& nack);
+	void    arqSkip(const uint8_t& len);
+	void    arqSendSkip();
+	void    arqNack(const bool& again);
+	void    arqRestart(const uint8_t& session, const uint8_t& base);
+	void    arqNext();
+	bool    arqDeliver();
+	void    txqUpdate();
+	void    txqFinish();
 };
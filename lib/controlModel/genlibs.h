@@ -2,3 +2,5 @@
 #include "src/controlModel_private.h"
 #include "src/controlModel_types.h"
 #include "src/rtwtypes.h"
+#include "src/controlModel_rates.h"
+#include "src/controlModel_params.h"
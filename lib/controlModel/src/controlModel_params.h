@@ -0,0 +1,68 @@
+//
+// File: controlModel_params.h
+//
+// Fields of the parameters 'params' of the Simulink model 'controlModel',
+// generated by gencode.m.
+//
+// The fields are exposed by name, offset and type for the online tuning
+// (e.g. with a ParamService), with the types of rtwtypes.h only.
+//
+#ifndef RTW_HEADER_controlModel_params_h_
+#define RTW_HEADER_controlModel_params_h_
+#include <stddef.h>
+#include "rtwtypes.h"
+#include "controlModel.h"
+
+// Fields of the parameters
+struct controlModel_params {
+  // Types of the fields
+  enum type_T : uint8_T {
+    REAL32 = 0U,                       // real32_T
+    REAL64 = 1U,                       // real_T, real64_T
+    INT8 = 2U,                         // int8_T
+    UINT8 = 3U,                        // uint8_T
+    INT16 = 4U,                        // int16_T
+    UINT16 = 5U,                       // uint16_T
+    INT32 = 6U,                        // int32_T
+    UINT32 = 7U,                       // uint32_T
+    BOOLEAN = 8U                       // boolean_T
+  };
+
+  // Field of the parameters
+  struct field_T {
+    const char_T *name;                // Name of the field
+    uint16_T offset;                   // Offset in the parameters (bytes)
+    uint8_T type;                      // Type of the field (type_T)
+    uint16_T count;                    // Number of elements (1 for scalars)
+  };
+
+  // Number of fields
+  static constexpr uint16_T NUM_FIELDS = 1U;
+
+  // Size of the parameters
+  static constexpr size_t SIZE = sizeof(params_type);
+
+  // Parameters
+  static params_type *data()
+  {
+    return &params;
+  }
+
+  // Fields
+  static const field_T *fields()
+  {
+    static const field_T f[NUM_FIELDS] = {
+      { "gain", offsetof(params_type, gain), REAL32, 1U }
+    };
+
+    return f;
+  }
+};
+
+#endif                                 // RTW_HEADER_controlModel_params_h_
+
+//
+// File trailer for generated code.
+//
+// [EOF]
+//
@@ -0,0 +1,98 @@
+//
+// File: controlModel_rates.h
+//
+// Rates of the Simulink model 'controlModel', generated by gencode.m.
+//
+// The step functions of the model run as periodic tasks of a RateScheduler,
+// each at its native rate. The faster rates have the higher priorities and
+// preempt the slower ones, as assumed by the rate transitions of the
+// multitasking code, thus the step functions must not be called elsewhere.
+//
+#ifndef RTW_HEADER_controlModel_rates_h_
+#define RTW_HEADER_controlModel_rates_h_
+#include "controlModel.h"
+#if defined(__IMXRT1062__)
+#include <RateScheduler.h>
+#endif
+
+// Rates of the model
+struct controlModel_rates {
+  // Number of rates
+  static constexpr uint8_t NUM_RATES = 1;
+
+  // Fundamental step in us
+  static constexpr uint32_t TICK = 1000U;
+
+  // Period of the rate in us
+  static constexpr uint32_t period(uint8_t tid)
+  {
+    return (tid == 0U) ? 1000U : 0U;
+  }
+
+  // Model of the step functions
+  static ControlClass *&model()
+  {
+    static ControlClass *m = nullptr;
+    return m;
+  }
+
+  // Hook function
+  typedef void (*hook_type)(void);
+
+  // Hook before the fastest step function (e.g. the input bindings)
+  static hook_type &before()
+  {
+    static hook_type f = nullptr;
+    return f;
+  }
+
+  // Hook after the fastest step function (e.g. the output bindings)
+  static hook_type &after()
+  {
+    static hook_type f = nullptr;
+    return f;
+  }
+
+  // Step functions
+  static void step0()
+  {
+    if (before() != nullptr) {
+      before()();
+    }
+
+    model()->update();
+    if (after() != nullptr) {
+      after()();
+    }
+  }
+
+#if defined(__IMXRT1062__)
+
+  // Add the step functions to the scheduler, fastest first.
+  // The hooks run in the task of the fastest rate, before and after its step.
+  // Returns the task index of the fastest rate (the others follow), -1 if failed.
+  static int8_t addTasks(RateScheduler &scheduler, ControlClass *m, hook_type
+    input = nullptr, hook_type output = nullptr)
+  {
+    model() = m;
+    before() = input;
+    after() = output;
+    int8_t index = scheduler.addTask(step0, period(0));
+    if (index < 0) {
+      return -1;
+    }
+
+    return index;
+  }
+
+#endif
+
+};
+
+#endif                                 // RTW_HEADER_controlModel_rates_h_
+
+//
+// File trailer for generated code.
+//
+// [EOF]
+//
@@ -43,6 +43,50 @@
 namespace bfs {
 #endif
 
+#ifdef SL_MOD //SL table-driven channel decoder
+namespace {
+  /*
+  * Channel i takes the 11 bits starting at bit 11 * i of the payload,
+  * so it is in the 32-bit word loaded at byte CH_BYTE_[i], shifted by CH_SHIFT_[i]
+  */
+  constexpr uint8_t CH_BYTE_[16] = {0, 1, 2, 4, 5, 6, 8, 9, 11, 12, 13, 15, 16, 17, 19, 20};
+  constexpr uint8_t CH_SHIFT_[16] = {0, 3, 6, 1, 4, 7, 2, 5, 0, 3, 6, 1, 4, 7, 2, 5};
+  inline int16_t Extract(const uint8_t *payload, const int8_t ch) {
+    uint32_t word;
+    memcpy(&word, payload + CH_BYTE_[ch], sizeof(word));  // unaligned little-endian load
+    return static_cast<int16_t>(word >> CH_SHIFT_[ch] & 0x07FF);
+  }
+}  // namespace
+void SbusRx::Decode(const uint8_t *payload, int16_t *ch) {
+  /* Unrolled, the last load reads 2 bytes past the payload (flags and footer) */
+  ch[0]  = Extract(payload, 0);
+  ch[1]  = Extract(payload, 1);
+  ch[2]  = Extract(payload, 2);
+  ch[3]  = Extract(payload, 3);
+  ch[4]  = Extract(payload, 4);
+  ch[5]  = Extract(payload, 5);
+  ch[6]  = Extract(payload, 6);
+  ch[7]  = Extract(payload, 7);
+  ch[8]  = Extract(payload, 8);
+  ch[9]  = Extract(payload, 9);
+  ch[10] = Extract(payload, 10);
+  ch[11] = Extract(payload, 11);
+  ch[12] = Extract(payload, 12);
+  ch[13] = Extract(payload, 13);
+  ch[14] = Extract(payload, 14);
+  ch[15] = Extract(payload, 15);
+}
+bool SbusRx::Calibrate(int8_t ch, int16_t min, int16_t center, int16_t max) {
+  if ((ch < 0) || (ch >= NUM_SBUS_CH_)) {
+    return false;
+  }
+  center_[ch] = center;
+  gain_neg_[ch] = (center != min) ? 1.0f / static_cast<float>(center - min) : 0.0f;
+  gain_pos_[ch] = (max != center) ? 1.0f / static_cast<float>(max - center) : 0.0f;
+  return true;
+}
+#endif
+
 #if defined(ESP32)
 void SbusRx::Begin(const int8_t rxpin, const int8_t txpin) {
 #else
@@ -80,6 +124,34 @@ void SbusRx::Begin() {
   uart_->flush();
 }
 bool SbusRx::Read() {
+  #if defined(SL_MOD) && defined(__IMXRT1062__)
+  if (port_) {
+    /* Take the latest frame published by the interrupt, again if it changes meanwhile */
+    uint32_t seq;
+    uint8_t flags;
+    do {
+      seq = pub_seq_;
+      __asm__ volatile("" ::: "memory");  // the frame is read after the sequence
+      if (seq == read_seq_) {
+        new_data_ = false;
+        Track();
+        return new_data_;
+      }
+      memcpy(ch_, pub_.ch, sizeof(ch_));
+      flags = pub_.flags;
+      timestamp_ = pub_.time;
+      __asm__ volatile("" ::: "memory");
+    } while (seq != pub_seq_);
+    read_seq_ = seq;
+    ch17_ = flags & CH17_MASK_;
+    ch18_ = flags & CH18_MASK_;
+    lost_frame_ = flags & LOST_FRAME_MASK_;
+    failsafe_ = flags & FAILSAFE_MASK_;
+    new_data_ = true;
+    Track();
+    return new_data_;
+  }
+  #endif
   /* Read through all available packets to get the newest */
   new_data_ = false;
   do {
@@ -90,6 +162,9 @@ bool SbusRx::Read() {
   /* Parse new data, if available */
   if (new_data_) {
     /* Grab the channel data */
+    #ifdef SL_MOD
+    Decode(buf_ + 1, ch_);
+    #else
     ch_[0]  = static_cast<int16_t>(buf_[1]       | buf_[2]  << 8 & 0x07FF);
     ch_[1]  = static_cast<int16_t>(buf_[2]  >> 3 | buf_[3]  << 5 & 0x07FF);
     ch_[2]  = static_cast<int16_t>(buf_[3]  >> 6 | buf_[4]  << 2  |
@@ -110,6 +185,7 @@ bool SbusRx::Read() {
                                    buf_[20] << 9 & 0x07FF);
     ch_[14] = static_cast<int16_t>(buf_[20] >> 2 | buf_[21] << 6 & 0x07FF);
     ch_[15] = static_cast<int16_t>(buf_[21] >> 5 | buf_[22] << 3 & 0x07FF);
+    #endif
     /* CH 17 */
     ch17_ = buf_[23] & CH17_MASK_;
     /* CH 18 */
@@ -118,9 +194,64 @@ bool SbusRx::Read() {
     lost_frame_ = buf_[23] & LOST_FRAME_MASK_;
     /* Grab the failsafe */
     failsafe_ = buf_[23] & FAILSAFE_MASK_;
+    #ifdef SL_MOD
+    timestamp_ = micros();
+    #endif
   }
+  #ifdef SL_MOD
+  Track();
+  #endif
   return new_data_;
 }
+#ifdef SL_MOD //SL link quality
+void SbusRx::Track() {
+  uint32_t now = micros();
+  if ((frames_ == 0) && (fps_start_ == 0)) {
+    fps_start_ = now;
+  }
+  if (new_data_) {
+    frames_++;
+    fps_count_++;
+    lost_hist_ = (lost_hist_ << 1) | lost_frame_;
+    if (hist_len_ < 64) {hist_len_++;}
+    if (!failsafe_) {
+      good_ = true;
+      last_good_ = timestamp_;
+    }
+  }
+  /* Frames per second, once per window */
+  if ((now - fps_start_) >= FPS_WINDOW_US_) {
+    fps_ = static_cast<float>(fps_count_) * 1e6f / static_cast<float>(now - fps_start_);
+    fps_count_ = 0;
+    fps_start_ = now;
+  }
+  /* Staleness, from the time of the last frame */
+  stale_ = (frames_ == 0) || (timeout_us_ && ((now - timestamp_) > timeout_us_));
+  /* Time in failsafe */
+  bool fs = failsafe_ || stale_;
+  if (fs && !fs_active_) {
+    fs_active_ = true;
+    fs_since_ = (stale_ && !failsafe_ && frames_) ? timestamp_ + timeout_us_ : now;
+  } else if (!fs && fs_active_) {
+    fs_active_ = false;
+    fs_total_us_ += now - fs_since_;
+  }
+}
+uint32_t SbusRx::failsafe_time() const {
+  uint64_t total = fs_total_us_;
+  if (fs_active_) {total += micros() - fs_since_;}
+  return static_cast<uint32_t>(total / 1000);
+}
+void SbusRx::ResetStats() {
+  hist_len_ = 0;
+  lost_hist_ = 0;
+  fps_count_ = 0;
+  fps_start_ = micros();
+  fps_ = 0.0f;
+  fs_total_us_ = 0;
+  fs_since_ = fps_start_;
+}
+#endif
 bool SbusRx::Parse() {
   /* Parse messages */
   while (uart_->available()) {
@@ -135,6 +266,14 @@ bool SbusRx::Parse() {
     } else {
       if (state_ < BUF_LEN_) {
         buf_[state_++] = cur_byte_;
+        #ifdef SL_MOD //SL frame complete at its last byte, not at the next one (the header of the next frame, which was lost)
+        if (state_ == BUF_LEN_) {
+          state_ = 0;
+          prev_byte_ = cur_byte_;
+          return (buf_[BUF_LEN_ - 1] == FOOTER_) ||
+                 ((buf_[BUF_LEN_ - 1] & 0x0F) == FOOTER2_);
+        }
+        #endif
       } else {
         state_ = 0;
         if ((buf_[BUF_LEN_ - 1] == FOOTER_) ||
@@ -150,6 +289,129 @@ bool SbusRx::Parse() {
   return false;
 }
 
+#if defined(SL_MOD) && defined(__IMXRT1062__) //SL interrupt-driven capture
+namespace {
+  /* LPUART, interrupt and interrupt handler of the hardware serials (Teensy 4.0 and 4.1 pinout) */
+  struct UartMap {
+    HardwareSerial *serial;
+    IMXRT_LPUART_t *port;
+    IRQ_NUMBER_t irq;
+    void (*uart_isr)();
+    uint8_t dmamux_tx;
+  };
+  const UartMap UART_MAP[] = {
+    {&Serial1, &IMXRT_LPUART6, IRQ_LPUART6, IRQHandler_Serial1,
+     DMAMUX_SOURCE_LPUART6_TX},
+    {&Serial2, &IMXRT_LPUART4, IRQ_LPUART4, IRQHandler_Serial2,
+     DMAMUX_SOURCE_LPUART4_TX},
+    {&Serial3, &IMXRT_LPUART2, IRQ_LPUART2, IRQHandler_Serial3,
+     DMAMUX_SOURCE_LPUART2_TX},
+    {&Serial4, &IMXRT_LPUART3, IRQ_LPUART3, IRQHandler_Serial4,
+     DMAMUX_SOURCE_LPUART3_TX},
+    {&Serial5, &IMXRT_LPUART8, IRQ_LPUART8, IRQHandler_Serial5,
+     DMAMUX_SOURCE_LPUART8_TX},
+    {&Serial6, &IMXRT_LPUART1, IRQ_LPUART1, IRQHandler_Serial6,
+     DMAMUX_SOURCE_LPUART1_TX},
+    {&Serial7, &IMXRT_LPUART7, IRQ_LPUART7, IRQHandler_Serial7,
+     DMAMUX_SOURCE_LPUART7_TX},
+    #if defined(ARDUINO_TEENSY41)
+    {&Serial8, &IMXRT_LPUART5, IRQ_LPUART5, IRQHandler_Serial8,
+     DMAMUX_SOURCE_LPUART5_TX},
+    #endif
+  };
+  constexpr uint32_t DATA_ERR_ = LPUART_DATA_NOISY | LPUART_DATA_PARITYE |
+                                 LPUART_DATA_FRETSC;
+  constexpr uint32_t STAT_ERR_ = LPUART_STAT_OR | LPUART_STAT_NF |
+                                 LPUART_STAT_FE | LPUART_STAT_PF;
+}  // namespace
+SbusRx *SbusRx::captures_[MAX_CAPTURES_] = {};
+bool SbusRx::BeginCapture() {
+  static void (*const ISRS[MAX_CAPTURES_])() = {IsrN<0>, IsrN<1>, IsrN<2>,
+    IsrN<3>, IsrN<4>, IsrN<5>, IsrN<6>, IsrN<7>};
+  int8_t idx = -1;
+  for (int8_t i = 0; i < static_cast<int8_t>(sizeof(UART_MAP) / sizeof(UART_MAP[0])); i++) {
+    if (UART_MAP[i].serial == uart_) {idx = i;}
+  }
+  if (idx < 0) {
+    return false;
+  }
+  Begin();
+  const UartMap &map = UART_MAP[idx];
+  NVIC_DISABLE_IRQ(map.irq);
+  cap_len_ = 0;
+  cap_err_ = false;
+  read_seq_ = pub_seq_;
+  uart_isr_ = map.uart_isr;
+  port_ = map.port;
+  captures_[idx] = this;
+  /* The end of a frame is the idle line (after the stop bit) for 4 characters */
+  uint32_t ctrl = port_->CTRL;
+  port_->CTRL = ctrl & ~LPUART_CTRL_RE;
+  port_->CTRL = (ctrl & ~LPUART_CTRL_IDLECFG(7)) | LPUART_CTRL_IDLECFG(2) |
+                LPUART_CTRL_ILT | LPUART_CTRL_RIE | LPUART_CTRL_ILIE;
+  attachInterruptVector(map.irq, ISRS[idx]);
+  NVIC_ENABLE_IRQ(map.irq);
+  return true;
+}
+void SbusRx::EndCapture() {
+  if (!port_) {
+    return;
+  }
+  for (int8_t i = 0; i < static_cast<int8_t>(sizeof(UART_MAP) / sizeof(UART_MAP[0])); i++) {
+    if (captures_[i] == this) {
+      /* Give the interrupt back to HardwareSerial, which ends the transmission, if any */
+      const UartMap &map = UART_MAP[i];
+      NVIC_DISABLE_IRQ(map.irq);
+      port_->CTRL &= ~LPUART_CTRL_ILIE;
+      captures_[i] = nullptr;
+      attachInterruptVector(map.irq, map.uart_isr);
+      NVIC_ENABLE_IRQ(map.irq);
+    }
+  }
+  uart_->end();
+  port_ = nullptr;
+}
+void SbusRx::Isr() {
+  uint32_t stat = port_->STAT;
+  /* Move the bytes in the FIFO to the frame being captured */
+  uint8_t avail = (port_->WATER >> 24) & 0x7;
+  while (avail--) {
+    uint32_t data = port_->DATA;
+    if (cap_len_ < BUF_LEN_) {
+      cap_buf_[cap_len_] = data;
+    }
+    if (cap_len_ <= BUF_LEN_) {
+      cap_len_++;  // BUF_LEN_ + 1 marks a too long frame
+    }
+    if (data & DATA_ERR_) {
+      cap_err_ = true;
+    }
+  }
+  if (stat & STAT_ERR_) {
+    cap_err_ = true;
+  }
+  /* Inter-frame gap, publish the frame if valid */
+  if (stat & LPUART_STAT_IDLE) {
+    if ((cap_len_ == BUF_LEN_) && !cap_err_ && (cap_buf_[0] == HEADER_) &&
+       ((cap_buf_[BUF_LEN_ - 1] == FOOTER_) ||
+       ((cap_buf_[BUF_LEN_ - 1] & 0x0F) == FOOTER2_))) {
+      Decode(cap_buf_ + 1, pub_.ch);
+      pub_.flags = cap_buf_[23];
+      pub_.time = micros() - IDLE_US_;
+      pub_seq_ = pub_seq_ + 1;
+    }
+    cap_len_ = 0;
+    cap_err_ = false;
+  }
+  /* Clear the flags seen, writing them back */
+  port_->STAT = stat;
+  /* Transmit, if any, is left to HardwareSerial */
+  if (port_->CTRL & (LPUART_CTRL_TIE | LPUART_CTRL_TCIE)) {
+    uart_isr_();
+  }
+}
+#endif
+
 /* Needed for emulating two stop bytes on Teensy 3.0 and 3.1/3.2 */
 #if defined(__MK20DX128__) || defined(__MK20DX256__)
 namespace {
@@ -169,12 +431,14 @@ namespace {
 }  // namespace
 #endif
 
-#ifndef SL_MOD //SL skip SbusTx
 #if defined(ESP32)
 void SbusTx::Begin(const int8_t rxpin, const int8_t txpin) {
 #else
 void SbusTx::Begin() {
 #endif
+  #ifdef SL_MOD //SL use teensy 4.1 always
+  uart_->begin(BAUD_, SERIAL_8E2_RXINV_TXINV);
+  #else
   /* Teensy 3.0 || Teensy 3.1/3.2 */
   #if defined(__MK20DX128__) || defined(__MK20DX256__)
   uart_->begin(BAUD_, SERIAL_8E1_RXINV_TXINV);
@@ -199,7 +463,104 @@ void SbusTx::Begin() {
   #else
   uart_->begin(BAUD_, SERIAL_8E2);
   #endif
+  #endif
+}
+#ifdef SL_MOD //SL packed with 64-bit words
+void SbusTx::Encode(const int16_t *ch, uint8_t *payload) {
+  /* Two groups of 8 channels, 88 bits each: 64 bits stored little-endian and 24 bits */
+  for (int8_t g = 0; g < 2; g++, ch += 8, payload += 11) {
+    uint64_t lo = static_cast<uint64_t>(ch[0] & 0x07FF)       |
+                  static_cast<uint64_t>(ch[1] & 0x07FF) << 11 |
+                  static_cast<uint64_t>(ch[2] & 0x07FF) << 22 |
+                  static_cast<uint64_t>(ch[3] & 0x07FF) << 33 |
+                  static_cast<uint64_t>(ch[4] & 0x07FF) << 44 |
+                  static_cast<uint64_t>(ch[5] & 0x07FF) << 55;
+    uint32_t hi = (ch[5] & 0x07FF) >> 9 | (ch[6] & 0x07FF) << 2 |
+                  (ch[7] & 0x07FF) << 13;
+    memcpy(payload, &lo, sizeof(lo));
+    payload[8] = static_cast<uint8_t>(hi);
+    payload[9] = static_cast<uint8_t>(hi >> 8);
+    payload[10] = static_cast<uint8_t>(hi >> 16);
+  }
 }
+void SbusTx::Write() {
+  uint8_t buf[BUF_LEN_];
+  buf[0] = HEADER_;
+  Encode(ch_, buf + 1);
+  buf[23] = 0x00 | (ch17_ * CH17_MASK_) | (ch18_ * CH18_MASK_) |
+            (failsafe_ * FAILSAFE_MASK_) | (lost_frame_ * LOST_FRAME_MASK_);
+  buf[24] = FOOTER_;
+  #if defined(__IMXRT1062__)
+  if (port_) {
+    /* Sent by the schedule */
+    __disable_irq();
+    memcpy(buf_, buf, sizeof(buf_));
+    armed_ = true;
+    __enable_irq();
+    return;
+  }
+  #endif
+  memcpy(buf_, buf, sizeof(buf_));
+  uart_->write(buf_, sizeof(buf_));
+}
+#if defined(__IMXRT1062__)
+SbusTx *SbusTx::schedules_[MAX_SCHEDULES_] = {};
+bool SbusTx::BeginSchedule(uint32_t period_us) {
+  static void (*const ISRS[MAX_SCHEDULES_])() = {IsrN<0>, IsrN<1>, IsrN<2>,
+    IsrN<3>};
+  const UartMap *map = nullptr;
+  for (const UartMap &m : UART_MAP) {
+    if (m.serial == uart_) {map = &m;}
+  }
+  int8_t slot = 0;
+  while ((slot < MAX_SCHEDULES_) && schedules_[slot]) {slot++;}
+  if (!map || (slot == MAX_SCHEDULES_) || port_) {
+    return false;
+  }
+  Begin();
+  port_ = map->port;
+  slot_ = slot;
+  schedules_[slot] = this;
+  armed_ = false;
+  busy_ = false;
+  /* One DMA request per byte while the TX FIFO has room, stopped after the frame */
+  dma_.disable();
+  dma_.sourceBuffer(dma_buf_, BUF_LEN_);
+  dma_.destination(*(volatile uint8_t *) &port_->DATA);
+  dma_.triggerAtHardwareEvent(map->dmamux_tx);
+  dma_.disableOnCompletion();
+  port_->BAUD |= LPUART_BAUD_TDMAE;
+  if (!timer_.begin(ISRS[slot], period_us)) {
+    EndSchedule();
+    return false;
+  }
+  return true;
+}
+void SbusTx::EndSchedule() {
+  if (!port_) {
+    return;
+  }
+  timer_.end();
+  dma_.disable();
+  port_->BAUD &= ~LPUART_BAUD_TDMAE;
+  schedules_[slot_] = nullptr;
+  port_ = nullptr;
+}
+void SbusTx::Isr() {
+  /* Send the latest frame, unless the previous one is still being moved */
+  if (!armed_ || (busy_ && !dma_.complete())) {
+    return;
+  }
+  memcpy((void *) dma_buf_, buf_, sizeof(buf_));
+  if ((uintptr_t) dma_buf_ >= 0x20200000u) {  // not in the DTCM, which is not cached
+    arm_dcache_flush((void *) dma_buf_, sizeof(buf_));
+  }
+  dma_.clearComplete();
+  dma_.enable();
+  busy_ = true;
+}
+#endif
+#else
 void SbusTx::Write() {
   /* Assemble packet */
   buf_[0] = HEADER_;
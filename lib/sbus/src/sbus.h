@@ -30,6 +30,9 @@
 
 #ifdef SL_MOD //for Arduino environment only
 #include <Arduino.h>
+#if defined(__IMXRT1062__)
+#include <DMAChannel.h>
+#endif
 #else
 #if defined(ARDUINO)
 #include <Arduino.h>
@@ -80,31 +83,117 @@ class SbusRx {
   #else
   bool failsafe_ = false, lost_frame_ = false, ch17_ = false, ch18_ = false;
   #endif
+  #ifdef SL_MOD //SL calibration for the normalized channels
+  static constexpr int16_t CH_MIN_ = 172;
+  static constexpr int16_t CH_CENTER_ = 992;
+  static constexpr int16_t CH_MAX_ = 1811;
+  int16_t center_[NUM_SBUS_CH_];
+  float gain_neg_[NUM_SBUS_CH_], gain_pos_[NUM_SBUS_CH_];
+  inline float Normalize(int8_t ch) const {
+    float val = static_cast<float>(ch_[ch] - center_[ch]) *
+                ((ch_[ch] < center_[ch]) ? gain_neg_[ch] : gain_pos_[ch]);
+    return (val > 1.0f) ? 1.0f : ((val < -1.0f) ? -1.0f : val);
+  }
+  #endif
+  #if defined(SL_MOD) && defined(__IMXRT1062__) //SL interrupt-driven capture
+  static constexpr uint32_t IDLE_US_ = 480;  // 4 idle characters (12 bits at 100 kbaud) end a frame
+  static constexpr int8_t MAX_CAPTURES_ = 8;
+  static SbusRx *captures_[MAX_CAPTURES_];
+  struct Frame {
+    int16_t ch[NUM_SBUS_CH_];
+    uint8_t flags;
+    uint32_t time;
+  };
+  IMXRT_LPUART_t *port_ = nullptr;
+  void (*uart_isr_)() = nullptr;
+  uint8_t cap_buf_[BUF_LEN_];
+  int8_t cap_len_ = 0;
+  bool cap_err_ = false;
+  Frame pub_;
+  volatile uint32_t pub_seq_ = 0;
+  uint32_t read_seq_ = 0;
+  void Isr();
+  template <int8_t N> static void IsrN() {captures_[N]->Isr();}
+  #endif
+  #ifdef SL_MOD //SL link quality
+  static constexpr uint32_t FPS_WINDOW_US_ = 1000000;
+  uint32_t timestamp_ = 0;
+  uint32_t frames_ = 0;
+  uint64_t lost_hist_ = 0;  // lost frame bits of the last 64 frames
+  int8_t hist_len_ = 0;
+  uint32_t fps_start_ = 0, fps_count_ = 0;
+  float fps_ = 0.0f;
+  bool good_ = false;
+  uint32_t last_good_ = 0;
+  uint32_t timeout_us_ = 0;
+  bool stale_ = true;
+  bool fs_active_ = false;
+  uint32_t fs_since_ = 0;
+  uint64_t fs_total_us_ = 0;
+  void Track();
+  #endif
   bool Parse();
 
  public:
+  #ifdef SL_MOD
+  explicit SbusRx(HardwareSerial *bus) : uart_(bus) {
+    for (int8_t i = 0; i < NUM_SBUS_CH_; i++) {
+      Calibrate(i, CH_MIN_, CH_CENTER_, CH_MAX_);
+    }
+  }
+  #else
   explicit SbusRx(HardwareSerial *bus) : uart_(bus) {}
+  #endif
   #if defined(ESP32)
   void Begin(const int8_t rxpin, const int8_t txpin);
   #else
   void Begin();
   #endif
   bool Read();
+  #if defined(SL_MOD) && defined(__IMXRT1062__)
+  bool BeginCapture(); //SL start the bus with frames captured by the LPUART interrupt, Read() then takes the latest one in O(1)
+  void EndCapture(); //SL give the interrupt back to HardwareSerial and end the bus
+  #endif
   static constexpr int8_t NUM_CH() {return NUM_SBUS_CH_;}
   #ifdef SL_MOD
+  inline uint32_t timestamp() const {return timestamp_;} //SL micros() at the end of the frame (capture), or at its Read()
+  inline float fps() const {return fps_;} //SL frames per second, over the last second
+  inline float lost_ratio() const { //SL ratio of frames with the lost frame bit, over the last 64 frames
+    return hist_len_ ? static_cast<float>(__builtin_popcountll(lost_hist_)) / hist_len_ : 0.0f;
+  }
+  inline uint32_t frame_age() const { //SL ms since the last frame not in failsafe, UINT32_MAX if none
+    return good_ ? (micros() - last_good_) / 1000 : UINT32_MAX;
+  }
+  uint32_t failsafe_time() const; //SL ms spent in failsafe
+  inline void stale_timeout(uint32_t ms) {timeout_us_ = ms * 1000;} //SL failsafe if no frame within ms (0 to disable)
+  inline bool stale() const {return stale_;}
+  void ResetStats();
   inline int16_t ch(size_t ch) {return ch_[ch];}
   inline void ch(int16_t* ch) { memcpy(ch, ch_, NUM_SBUS_CH_*sizeof(int16_t));}
   inline void ch(int16_t* ch, size_t len) { memcpy(ch, ch_, len);}
+  static void Decode(const uint8_t *payload, int16_t *ch); //SL unpack the 16 channels of the 22-byte payload of a frame (buf + 1, 2 more bytes are read)
+  bool Calibrate(int8_t ch, int16_t min, int16_t center, int16_t max); //SL raw values for -1, 0 and 1 of a channel, false if no such channel
+  inline void ch_norm(float *ch, size_t len) const { //SL normalized channels, -1..1 (at most NUM_SBUS_CH_)
+    if (len > NUM_SBUS_CH_) {len = NUM_SBUS_CH_;}
+    for (size_t i = 0; i < len; i++) {ch[i] = Normalize(i);}
+  }
+  inline void ch_norm(float *const *ch, size_t len) const { //SL normalized channels to scattered destinations (e.g. fields of a struct), NULL to skip
+    if (len > NUM_SBUS_CH_) {len = NUM_SBUS_CH_;}
+    for (size_t i = 0; i < len; i++) {if (ch[i]) {*ch[i] = Normalize(i);}}
+  }
   #else
   inline std::array<int16_t, NUM_SBUS_CH_> ch() const {return ch_;}
   #endif
+  #ifdef SL_MOD
+  inline bool failsafe() const {return failsafe_ || stale_;} //SL also when stale
+  #else
   inline bool failsafe() const {return failsafe_;}
+  #endif
   inline bool lost_frame() const {return lost_frame_;}
   inline bool ch17() const {return ch17_;}
   inline bool ch18() const {return ch18_;}
 };
 
-#ifndef SL_MOD //SL skip SbusTx
 class SbusTx {
  private:
   /* Communication */
@@ -123,8 +212,24 @@ class SbusTx {
   static constexpr uint8_t FAILSAFE_MASK_ = 0x08;
   /* Data */
   uint8_t buf_[BUF_LEN_];
+  #ifdef SL_MOD //SL use standard array instead of std::array
+  int16_t ch_[NUM_SBUS_CH_] = {  };
+  #else
   std::array<int16_t, NUM_SBUS_CH_> ch_;
+  #endif
   bool failsafe_ = false, lost_frame_ = false, ch17_ = false, ch18_ = false;
+  #if defined(SL_MOD) && defined(__IMXRT1062__) //SL frames sent by DMA on a schedule
+  static constexpr int8_t MAX_SCHEDULES_ = 4;  // IntervalTimer channels
+  static SbusTx *schedules_[MAX_SCHEDULES_];
+  IMXRT_LPUART_t *port_ = nullptr;
+  int8_t slot_ = -1;
+  bool armed_ = false, busy_ = false;
+  DMAChannel dma_;
+  IntervalTimer timer_;
+  volatile uint8_t dma_buf_[BUF_LEN_];
+  void Isr();
+  template <int8_t N> static void IsrN() {schedules_[N]->Isr();}
+  #endif
 
  public:
   explicit SbusTx(HardwareSerial *bus) : uart_(bus) {}
@@ -134,19 +239,29 @@ class SbusTx {
   void Begin();
   #endif
   void Write();
+  #if defined(SL_MOD) && defined(__IMXRT1062__)
+  bool BeginSchedule(uint32_t period_us = 14000); //SL start the bus with the frame sent by DMA every period (7000 or 14000 us), Write() then only updates it
+  void EndSchedule();
+  #endif
   static constexpr int8_t NUM_CH() {return NUM_SBUS_CH_;}
   inline void failsafe(const bool val) {failsafe_ = val;}
   inline void lost_frame(const bool val) {lost_frame_ = val;}
   inline void ch17(const bool val) {ch17_ = val;}
   inline void ch18(const bool val) {ch18_ = val;}
+  #ifdef SL_MOD
+  static void Encode(const int16_t *ch, uint8_t *payload); //SL pack the 16 channels in the 22-byte payload of a frame (buf + 1)
+  inline void ch(const int16_t *cmd) {memcpy(ch_, cmd, sizeof(ch_));}
+  inline void ch(size_t ch, int16_t cmd) {ch_[ch] = cmd;}
+  inline int16_t ch(size_t ch) const {return ch_[ch];}
+  #else
   inline void ch(const std::array<int16_t, NUM_SBUS_CH_> &cmd) {ch_ = cmd;}
   inline std::array<int16_t, NUM_SBUS_CH_> ch() const {return ch_;}
+  #endif
   inline bool failsafe() const {return failsafe_;}
   inline bool lost_frame() const {return lost_frame_;}
   inline bool ch17() const {return ch17_;}
   inline bool ch18() const {return ch18_;}
 };
-#endif
 
 #ifndef SL_MOD
 }  // namespace bfs
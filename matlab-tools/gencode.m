@@ -79,6 +79,9 @@ Simulink.fileGenControl('set', ...
 
 load_system([modelname '.slx']); %load simulink model
 set_param(modelname,'GenCodeOnly','on'); %set generate code only to on (do not generate .exe, useless)
+set_param(modelname,'EnableMultiTasking','on'); %multitasking, i.e. one step function for each rate of multi-rate models
+set_param(modelname,'AutoInsertRateTranBlk','on'); %insert the rate transitions (buffers) between rates
+set_param(modelname,'PortableWordSizes','on'); %allow host builds (e.g. host-tools) with -DPORTABLE_WORDSIZES
 if ispc %Windows - Automatically locate an installed toolchain not wokring b/c only for C, not C++
     set_param(modelname,'Toolchain','Microsoft Visual C++ 2017 v15.0 | nmake (64-bit Windows'); %Use MV C++
 elseif isunix || ismac %Unix/Linux or Mac - use Automatically locate an installed toolchain
@@ -145,6 +148,151 @@ for k = 1 : numel(list_cpp_shared)
         copyfile([dir_shared list_cpp_shared(k).name], [dir_codegen list_cpp_shared(k).name]);
     end
 end
+
+%% make rates file to run the step functions at their native rates
+fprintf('### Generating rates file...\n');
+rates_file = [modelname '_rates.h'];
+header = fileread([dir_codegen modelname '.h']);
+classname = regexp(header, 'class\s+(\w+)\s*\{', 'tokens', 'once'); %model class
+if isempty(classname)
+    error('model class not found, the C++ class interface is required');
+end
+classname = classname{1};
+steps = regexp(header, 'model step function for TID(\d+)\s+void\s+(\w+)\(\);', 'tokens'); %multi-rate
+if isempty(steps) %single-rate
+    steps = regexp(header, 'model step function\s+void\s+(\w+)\(\);', 'tokens');
+    if isempty(steps)
+        error('model step function not found');
+    end
+    steps = {{'0', steps{1}{1}}};
+end
+sampletimes = Simulink.BlockDiagram.getSampleTimes(modelname); %sample times with task IDs
+numrates = numel(steps);
+periods = zeros(1, numrates);
+for k = 1 : numrates
+    tid = str2double(steps{k}{1});
+    idx = find(arrayfun(@(st) isequal(st.TID, tid) && isfinite(st.Value(1)) && (st.Value(1) > 0), sampletimes), 1);
+    if isempty(idx)
+        error('sample time of TID%d not found', tid);
+    end
+    periods(k) = round(sampletimes(idx).Value(1) * 1e6); %period in us
+end
+tick = periods(1);
+for k = 2 : numrates
+    tick = gcd(tick, periods(k)); %fundamental step
+end
+period_expr = '0U';
+for k = numrates : -1 : 1
+    period_expr = sprintf('(tid == %dU) ? %dU : %s', k-1, periods(k), period_expr);
+end
+
+ratesID = fopen([dir_codegen rates_file],'w');
+fprintf(ratesID,'//\n// File: %s\n//\n', rates_file);
+fprintf(ratesID,'// Rates of the Simulink model ''%s'', generated by gencode.m.\n//\n', modelname);
+fprintf(ratesID,'// The step functions of the model run as periodic tasks of a RateScheduler,\n');
+fprintf(ratesID,'// each at its native rate. The faster rates have the higher priorities and\n');
+fprintf(ratesID,'// preempt the slower ones, as assumed by the rate transitions of the\n');
+fprintf(ratesID,'// multitasking code, thus the step functions must not be called elsewhere.\n//\n');
+fprintf(ratesID,'#ifndef RTW_HEADER_%s_rates_h_\n#define RTW_HEADER_%s_rates_h_\n', modelname, modelname);
+fprintf(ratesID,'#include "%s.h"\n#if defined(__IMXRT1062__)\n#include <RateScheduler.h>\n#endif\n\n', modelname);
+fprintf(ratesID,'// Rates of the model\nstruct %s_rates {\n', modelname);
+fprintf(ratesID,'  // Number of rates\n  static constexpr uint8_t NUM_RATES = %d;\n\n', numrates);
+fprintf(ratesID,'  // Fundamental step in us\n  static constexpr uint32_t TICK = %dU;\n\n', tick);
+fprintf(ratesID,'  // Period of the rate in us\n  static constexpr uint32_t period(uint8_t tid)\n  {\n    return %s;\n  }\n\n', period_expr);
+fprintf(ratesID,'  // Model of the step functions\n  static %s *&model()\n  {\n    static %s *m = nullptr;\n    return m;\n  }\n\n', classname, classname);
+fprintf(ratesID,'  // Hook function\n  typedef void (*hook_type)(void);\n\n');
+fprintf(ratesID,'  // Hook before the fastest step function (e.g. the input bindings)\n  static hook_type &before()\n  {\n    static hook_type f = nullptr;\n    return f;\n  }\n\n');
+fprintf(ratesID,'  // Hook after the fastest step function (e.g. the output bindings)\n  static hook_type &after()\n  {\n    static hook_type f = nullptr;\n    return f;\n  }\n\n');
+fprintf(ratesID,'  // Step functions\n');
+fprintf(ratesID,'  static void step0()\n  {\n    if (before() != nullptr) {\n      before()();\n    }\n\n    model()->%s();\n    if (after() != nullptr) {\n      after()();\n    }\n  }\n\n', steps{1}{2});
+for k = 2 : numrates
+    fprintf(ratesID,'  static void step%d()\n  {\n    model()->%s();\n  }\n\n', k-1, steps{k}{2});
+end
+fprintf(ratesID,'#if defined(__IMXRT1062__)\n\n');
+fprintf(ratesID,'  // Add the step functions to the scheduler, fastest first.\n');
+fprintf(ratesID,'  // The hooks run in the task of the fastest rate, before and after its step.\n');
+fprintf(ratesID,'  // Returns the task index of the fastest rate (the others follow), -1 if failed.\n');
+fprintf(ratesID,'  static int8_t addTasks(RateScheduler &scheduler, %s *m, hook_type\n    input = nullptr, hook_type output = nullptr)\n  {\n', classname);
+fprintf(ratesID,'    model() = m;\n    before() = input;\n    after() = output;\n    int8_t index = scheduler.addTask(step0, period(0));\n    if (index < 0) {\n      return -1;\n    }\n\n');
+for k = 2 : numrates
+    fprintf(ratesID,'    if (scheduler.addTask(step%d, period(%d)) < 0) {\n      return -1;\n    }\n\n', k-1, k-1);
+end
+fprintf(ratesID,'    return index;\n  }\n\n#endif\n\n};\n\n');
+fprintf(ratesID,'#endif                                 // RTW_HEADER_%s_rates_h_\n\n', modelname);
+fprintf(ratesID,'//\n// File trailer for generated code.\n//\n// [EOF]\n//\n');
+fclose(ratesID);
+fprintf(fileID,'#include "src/%s"\n', rates_file);
+
+%% make params file to expose the fields of the parameters for the online tuning
+paramsdef = regexp(header, 'custom storage class: Struct\s+struct\s+(\w+)\s*\{([^}]*)\};', 'tokens', 'once'); %parameters struct
+if isempty(paramsdef)
+    fprintf('### No parameters struct found, skipping params file...\n');
+else
+    fprintf('### Generating params file...\n');
+    params_file = [modelname '_params.h'];
+    paramstype = paramsdef{1};
+    paramsname = regexp(header, ['extern\s+' paramstype '\s+(\w+);'], 'tokens', 'once'); %parameters variable
+    if isempty(paramsname)
+        error('parameters variable of type %s not found', paramstype);
+    end
+    paramsname = paramsname{1};
+    types = containers.Map( ...
+        {'real32_T', 'real_T', 'real64_T', 'int8_T', 'uint8_T', 'int16_T', 'uint16_T', 'int32_T', 'uint32_T', 'boolean_T'}, ...
+        {'REAL32', 'REAL64', 'REAL64', 'INT8', 'UINT8', 'INT16', 'UINT16', 'INT32', 'UINT32', 'BOOLEAN'});
+    typevalues = { ... %type values (as ParamField::Type of ParamService) and rtwtypes.h types
+        'REAL32', 'real32_T'; 'REAL64', 'real_T, real64_T'; 'INT8', 'int8_T'; 'UINT8', 'uint8_T'; 'INT16', 'int16_T'; ...
+        'UINT16', 'uint16_T'; 'INT32', 'int32_T'; 'UINT32', 'uint32_T'; 'BOOLEAN', 'boolean_T'};
+    fields = regexp(paramsdef{2}, '(\w+)\s+(\w+)(\[\d+\])?;', 'tokens'); %type, name, size
+    if isempty(fields)
+        error('no fields found in %s', paramstype);
+    end
+
+    paramsID = fopen([dir_codegen params_file],'w');
+    fprintf(paramsID,'//\n// File: %s\n//\n', params_file);
+    fprintf(paramsID,'// Fields of the parameters ''%s'' of the Simulink model ''%s'',\n// generated by gencode.m.\n//\n', paramsname, modelname);
+    fprintf(paramsID,'// The fields are exposed by name, offset and type for the online tuning\n// (e.g. with a ParamService), with the types of rtwtypes.h only.\n//\n');
+    fprintf(paramsID,'#ifndef RTW_HEADER_%s_params_h_\n#define RTW_HEADER_%s_params_h_\n', modelname, modelname);
+    fprintf(paramsID,'#include <stddef.h>\n#include "rtwtypes.h"\n#include "%s.h"\n\n', modelname);
+    fprintf(paramsID,'// Fields of the parameters\nstruct %s_params {\n', modelname);
+    fprintf(paramsID,'  // Types of the fields\n  enum type_T : uint8_T {\n');
+    for k = 1 : size(typevalues, 1)
+        separator = ',';
+        if k == size(typevalues, 1)
+            separator = '';
+        end
+        fprintf(paramsID,'    %-35s// %s\n', sprintf('%s = %dU%s', typevalues{k, 1}, k-1, separator), typevalues{k, 2});
+    end
+    fprintf(paramsID,'  };\n\n');
+    fprintf(paramsID,'  // Field of the parameters\n  struct field_T {\n');
+    fprintf(paramsID,'    %-35s// %s\n', 'const char_T *name;', 'Name of the field');
+    fprintf(paramsID,'    %-35s// %s\n', 'uint16_T offset;', 'Offset in the parameters (bytes)');
+    fprintf(paramsID,'    %-35s// %s\n', 'uint8_T type;', 'Type of the field (type_T)');
+    fprintf(paramsID,'    %-35s// %s\n', 'uint16_T count;', 'Number of elements (1 for scalars)');
+    fprintf(paramsID,'  };\n\n');
+    fprintf(paramsID,'  // Number of fields\n  static constexpr uint16_T NUM_FIELDS = %dU;\n\n', numel(fields));
+    fprintf(paramsID,'  // Size of the parameters\n  static constexpr size_t SIZE = sizeof(%s);\n\n', paramstype);
+    fprintf(paramsID,'  // Parameters\n  static %s *data()\n  {\n    return &%s;\n  }\n\n', paramstype, paramsname);
+    fprintf(paramsID,'  // Fields\n  static const field_T *fields()\n  {\n    static const field_T f[NUM_FIELDS] = {\n');
+    for k = 1 : numel(fields)
+        if ~isKey(types, fields{k}{1})
+            error('type %s of the field %s not supported', fields{k}{1}, fields{k}{2});
+        end
+        count = 1;
+        if ~isempty(fields{k}{3})
+            count = str2double(fields{k}{3}(2:end-1));
+        end
+        separator = ',';
+        if k == numel(fields)
+            separator = '';
+        end
+        fprintf(paramsID,'      { "%s", offsetof(%s, %s), %s, %dU }%s\n', fields{k}{2}, paramstype, fields{k}{2}, types(fields{k}{1}), count, separator);
+    end
+    fprintf(paramsID,'    };\n\n    return f;\n  }\n};\n\n');
+    fprintf(paramsID,'#endif                                 // RTW_HEADER_%s_params_h_\n\n', modelname);
+    fprintf(paramsID,'//\n// File trailer for generated code.\n//\n// [EOF]\n//\n');
+    fclose(paramsID);
+    fprintf(fileID,'#include "src/%s"\n', params_file);
+end
 fclose(fileID);
 
 %% end
@@ -23,8 +23,73 @@
     @{
 */
 
+//scheduler and model
+constexpr uint32_t SCHEDULER_TICK = 250; //!< Base tick of the scheduler in us (4 kHz).
+static_assert(controlModel_rates::TICK % SCHEDULER_TICK == 0, "the model rates must be multiples of the scheduler tick");
+RateScheduler scheduler(SCHEDULER_TICK); //!< Scheduler of the periodic tasks.
+int8_t sensorTaskIndex = -1; //!< Task index of the sensor task, masked by the model bindings.
+ControlClass model; //!< Control model, stepped at its rates by the scheduler.
+ParamService paramService(controlModel_params{}); //!< Online tuning of the model parameters.
+
+//driver buffers
+uint16_t adcRaw[2]; //!< ADC readings, written by the sensor task.
+uint16_t dacCode[2]; //!< DAC codes, written by the model outputs.
+
+//conversions
+typedef modelbinding::Linear<std::ratio<33, 40950>> AdcToVolt; //!< 12-bit ADC code to V (3.3 V reference).
+typedef modelbinding::Clamp<0, 4095, modelbinding::Linear<std::ratio<40950, 33>>> VoltToDac; //!< V to 12-bit DAC code (3.3 V reference).
+
+//bindings
+auto modelInputs = modelbinding::bindings( //!< Bindings from the drivers to the model inputs, applied before each model step.
+	modelbinding::bind<AdcToVolt>(&model.controlModel_U.input1, &adcRaw[0]),
+	modelbinding::bind<AdcToVolt>(&model.controlModel_U.input2, &adcRaw[1]));
+auto modelOutputs = modelbinding::bindings( //!< Bindings from the model outputs to the drivers, applied after each model step.
+	modelbinding::bind<VoltToDac>(&dacCode[0], &model.controlModel_Y.output1),
+	modelbinding::bind<VoltToDac>(&dacCode[1], &model.controlModel_Y.output2));
+
+/*! \brief Sensor task.
+	\details Periodic task at 4 kHz, reading the sensors.
+*/
+void sensorTask() {
+	//sensor and actuator stuff here (e.g. read adcRaw and write dacCode)
+}
+
+/*! \brief Telemetry task.
+	\details Periodic task at 100 Hz, sending the telemetry.
+*/
+void telemetryTask() {
+	//telemetry stuff here
+}
+
+/*! \brief Background task.
+	\details Background task, running when no periodic task is running (e.g. SD flush).
+*/
+void backgroundTask() {
+	//background stuff here (e.g. paramService.stage() and paramService.commit() on the host messages)
+}
+
+/*! \brief Halt.
+	\details Stop on a startup error (e.g. a task not added or the scheduler not started), printing the error and blinking the built-in LED forever.
+	\param msg The error message.
+*/
+void halt(const char* msg) {
+	pinMode(LED_BUILTIN, OUTPUT);
+	while (1) {
+		Serial.println(msg);
+		digitalToggleFast(LED_BUILTIN);
+		delay(500);
+	}
+}
+
 /*! \brief Entry-point function.
 	\details Definition for main function, which is the entry-point function of the code.
+	The periodic tasks run in interrupts with fixed priorities (the faster, the higher) by the RateScheduler, 
+	while the background tasks run in the infinite loop of RateScheduler::run().
+	The model inputs and outputs are read and written directly by the ModelBinding bindings, in the task of the model step.
+	The sensor task preempts the model task, thus the bindings are applied atomically (ModelBinding::applyAtomic()), from a consistent
+	snapshot of the readings (e.g. both `adcRaw` of the same run of the sensor task) and with all the DAC codes of the same step.
+	Only the sensor task and the lower priorities are masked meanwhile, the serials and the USB are not.
+	The parameters changed online with the ParamService are applied in the same task, before the step.
 	The function implementation is structured as follows
 
 	```
@@ -32,24 +97,39 @@
 
 		//initializations here
 
-		while(1) { //infinite loop, running forever
-			//loop here
-		}
+		sensorTaskIndex = scheduler.addTask(sensorTask, 250); //4 kHz
+		if (sensorTaskIndex < 0) halt("ERROR: sensor task not added");
+		if (controlModel_rates::addTasks(scheduler, &model, //model step functions at their rates
+			[]() { paramService.apply(); modelInputs.applyAtomic(scheduler.priority(sensorTaskIndex)); }, //committed parameters and drivers to model inputs
+			[]() { modelOutputs.applyAtomic(scheduler.priority(sensorTaskIndex)); }) < 0) halt("ERROR: model tasks not added"); //model outputs to drivers
+		if (scheduler.addTask(telemetryTask, 10000) < 0) halt("ERROR: telemetry task not added"); //100 Hz
+		scheduler.addBackground(backgroundTask); //background
+		if (!scheduler.begin()) halt("ERROR: scheduler not started"); //start periodic tasks
+		scheduler.run(); //infinite loop with background tasks, running forever
 
 		return 0;
 	}
 	```
 
 	\return The exit status (0 by default).
-    \see main.cpp
+    \see main.cpp RateScheduler
 */
 int main() {
 
 	//initializations here
+	ControlClass::begin(); //init model
+	paramService.begin(); //init online tuning
 
-	while(1) { //infinite loop, running forever
-		//loop stuff here
-	}
+	sensorTaskIndex = scheduler.addTask(sensorTask, 250); //4 kHz
+	if (sensorTaskIndex < 0) halt("ERROR: sensor task not added");
+	if (controlModel_rates::addTasks(scheduler, &model, //model step functions at their rates (1 kHz)
+		[]() { paramService.apply(); modelInputs.applyAtomic(scheduler.priority(sensorTaskIndex)); }, //committed parameters and drivers to model inputs
+		[]() { modelOutputs.applyAtomic(scheduler.priority(sensorTaskIndex)); }) < 0) halt("ERROR: model tasks not added"); //model outputs to drivers
+	if (scheduler.addTask(telemetryTask, 10000) < 0) halt("ERROR: telemetry task not added"); //100 Hz
+	scheduler.addBackground(backgroundTask); //background
+	if (!scheduler.begin()) halt("ERROR: scheduler not started"); //start periodic tasks
+
+	scheduler.run(); //infinite loop with background tasks, running forever
 
 	return 0; //mandatory
 }